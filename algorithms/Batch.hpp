@@ -0,0 +1,72 @@
+#ifndef BATCH_HPP
+#define BATCH_HPP
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "Solver.hpp"
+
+/**
+ * @struct BatchResult
+ * @brief Outcome of one (instance, algorithm, seed) job.
+ */
+struct BatchResult {
+  std::string instance;
+  std::string algorithm;  ///< GRASP, HUB or CONSTRUCTIVE
+  unsigned int seed = 0;
+  double firstCost = 0.0;
+  double cost = 0.0;
+  double timeMs = 0.0;  ///< Solve time, the instance load is shared and excluded
+  bool feasible = false;
+  int nNodes = 0;
+  int nEdges = 0;
+  int nTerminals = 0;
+  std::string error;  ///< Non-empty if the job could not run
+};
+
+/**
+ * @class BatchRunner
+ * @brief Solves many instances per process on a thread pool.
+ * * Jobs are ordered instance by instance and handed out dynamically to the
+ * pool workers, so the seeds of an instance run side by side on one parsed
+ * SFPProblem, loaded by its first job and freed after its last one. The
+ * engines, landmarks and path cache of finished jobs are pooled per instance
+ * and reused by the next ones (see SolverResources). Each job solves with the
+ * base config and its own seed, hence the same result as a single run with
+ * that seed.
+ */
+class BatchRunner {
+ private:
+  SolverConfig base;
+  int nJobs;
+
+ public:
+  /**
+   * @param base Solver parameters of every job (the seed is overridden).
+   * @param nJobs Jobs run concurrently.
+   */
+  BatchRunner(SolverConfig base, const int nJobs);
+
+  /**
+   * @brief Instances of a directory (recursive .stp/.sfpb files, sorted) or
+   * of a manifest (one path per line, `#` comments, relative to the manifest).
+   * @throws std::runtime_error if the source or a listed file is missing.
+   */
+  static std::vector<std::string> listInstances(const std::string& source);
+
+  /**
+   * @brief Runs every instance x algorithm x seed job.
+   * @param onResult Called once per finished job, serialized, in completion order.
+   */
+  void run(const std::vector<std::string>& instances, const std::vector<std::string>& algorithms,
+           const std::vector<unsigned int>& seeds,
+           const std::function<void(const BatchResult&)>& onResult) const;
+
+  static void writeCSVHeader(std::ostream& out);
+  static void writeCSV(std::ostream& out, const BatchResult& result);
+  static void writeJSON(std::ostream& out, const BatchResult& result);
+};
+
+#endif
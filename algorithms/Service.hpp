@@ -0,0 +1,143 @@
+#ifndef SERVICE_HPP
+#define SERVICE_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "Solver.hpp"
+
+enum class JobStatus { QUEUED, RUNNING, DONE, CANCELLED, FAILED };
+
+/**
+ * @struct ServiceResult
+ * @brief Outcome of a submitted solve.
+ */
+struct ServiceResult {
+  JobStatus status = JobStatus::QUEUED;
+  std::optional<SFPSolution> solution;  ///< Missing if cancelled before it ran, or failed
+  double firstCost = 0.0;
+  double timeMs = 0.0;  ///< Solve time, the wait in the queue is excluded
+  std::string error;    ///< Non-empty if the job failed
+};
+
+/**
+ * @class SolverService
+ * @brief Asynchronous front end of the metaheuristics for long-running hosts.
+ * * Jobs are queued and solved in submission order by `nThreads` service
+ * threads, each job with its own SolverConfig (nThreads of the config still
+ * sets the restart workers of that job). The callbacks of the config
+ * (onIncumbent, onProgress) run on the service thread of the job.
+ * * Per instance (problem, queue, landmarks), the service keeps the landmark
+ * tables, the shortest path cache and idle sets of Dijkstra engines, so the
+ * next job on the same problem skips their construction. The path cache keeps
+ * the budget of the job that created it. Warm state holds the graph alive
+ * until forget() or the end of the service.
+ * * Results are the same as a direct Metaheuristics run with the same config.
+ */
+class SolverService {
+ private:
+  struct Job {
+    std::shared_ptr<const SFPProblem> problem;
+    std::string algorithm;
+    SolverConfig config;
+    std::atomic<bool> cancelled{false};
+
+    std::mutex mutex;
+    std::condition_variable finished;
+    ServiceResult result;
+
+    /// Raises the stop flag, and publishes CANCELLED at once if the job has not started
+    void cancel();
+  };
+
+  struct Session {
+    std::weak_ptr<const SFPProblem> problem;
+    std::shared_ptr<const Landmarks> landmarks;
+    std::shared_ptr<ShortestPathCache> pathCache;
+    std::vector<std::shared_ptr<SolverResources>> idle;
+  };
+  using SessionKey = std::tuple<const SFPProblem*, QueueKind, int>;
+
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::deque<std::shared_ptr<Job>> queue;
+  std::vector<std::shared_ptr<Job>> running;
+  std::map<SessionKey, Session> sessions;
+  bool stopping = false;
+  std::vector<std::thread> threads;
+
+  void workerLoop();
+  void execute(Job& job);
+  std::shared_ptr<SolverResources> acquire(const Job& job);
+  void release(const Job& job, std::shared_ptr<SolverResources> resources);
+
+ public:
+  /**
+   * @class Handle
+   * @brief Client side of a submitted job, cheap to copy.
+   */
+  class Handle {
+   private:
+    std::shared_ptr<Job> job;
+
+    /// The job of the handle, throws on an empty one
+    Job& get() const;
+
+   public:
+    /// Empty handle, to be assigned from submit(). Its other methods throw std::runtime_error
+    Handle() = default;
+    explicit Handle(std::shared_ptr<Job> job) : job(std::move(job)) {}
+
+    bool valid() const { return job != nullptr; }
+
+    JobStatus status() const;
+
+    /**
+     * @brief Asks the job to stop. A queued job is dropped and finishes
+     * CANCELLED right away, a running one stops like on a time limit and
+     * keeps its best solution.
+     */
+    void cancel();
+
+    /// Waits up to `timeoutMs` for the job, true once finished
+    bool waitFor(double timeoutMs) const;
+
+    /// Waits for the job and returns its outcome
+    const ServiceResult& result() const;
+  };
+
+  /**
+   * @param nThreads Jobs solved concurrently.
+   */
+  explicit SolverService(const int nThreads = 1);
+
+  /// Cancels the queued and running jobs and waits for the threads
+  ~SolverService();
+
+  SolverService(const SolverService&) = delete;
+  SolverService& operator=(const SolverService&) = delete;
+
+  /**
+   * @brief Queues a solve of `problem` with GRASP or HUB.
+   * @throws std::runtime_error on an unknown algorithm or a stopped service.
+   */
+  Handle submit(std::shared_ptr<const SFPProblem> problem, const std::string& algorithm,
+                SolverConfig config = {});
+
+  /// Drops the warm state of a problem (jobs already running keep theirs)
+  void forget(const SFPProblem* problem);
+
+  /// Instances with warm state
+  int warmInstances();
+};
+
+#endif
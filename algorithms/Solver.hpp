@@ -1,12 +1,87 @@
 #ifndef SOLVER_HPP
 #define SOLVER_HPP
 
-#include <random>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
 #include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
 #include "../models/SFP.hpp"
 #include "../utils/BidDijkstra.hpp"
+#include "../utils/Dijkstra.hpp"
+#include "../utils/PathCache.hpp"
+#include "../utils/ThreadPool.hpp"
+
+/**
+ * @struct Incumbent
+ * @brief New best solution of a run, as reported to SolverConfig::onIncumbent.
+ */
+struct Incumbent {
+  const SFPSolution* solution;  ///< Only valid during the callback
+  double cost;
+  double elapsedMs;  ///< Since the start of solve()
+  int iteration;     ///< Restart that found it
+};
+
+/**
+ * @struct Progress
+ * @brief State of a run after a restart, as reported to SolverConfig::onProgress.
+ */
+struct Progress {
+  int completed;     ///< Restarts done so far, all workers together
+  int total;         ///< SolverConfig::maxIterations
+  double bestCost;   ///< Global incumbent (infinity before the first one)
+  double elapsedMs;  ///< Since the start of solve()
+};
+
+/**
+ * @struct SolverResources
+ * @brief Instance-bound objects a run reuses instead of building them.
+ * * Missing pieces are built by the first run and kept here for the next
+ * ones, which must use the same problem, queue and number of landmarks. The
+ * engines carry search state, so two runs may not share a set at once.
+ */
+struct SolverResources {
+  std::shared_ptr<const Landmarks> landmarks;
+  std::shared_ptr<ShortestPathCache> pathCache;
+  std::vector<std::shared_ptr<BidirectionalDijkstraEngine>> engines;  ///< One per worker
+};
+
+/**
+ * @struct SolverConfig
+ * @brief Run parameters of the metaheuristic orchestrators.
+ */
+struct SolverConfig {
+  int maxIterations = 1;  ///< Number of construct + local search restarts
+  float alpha = 1.0f;     ///< RCL size factor of the constructive phase
+  int nThreads = 1;       ///< Worker threads sharing the restarts
+  int nLandmarks = 0;     ///< ALT landmarks of the Dijkstra engines (0 disables)
+  QueueKind queue = QueueKind::AUTO;  ///< Priority queue policy of the Dijkstra engines
+  int lsThreads = 1;      ///< Threads evaluating GRASPLocalSearch moves, per worker
+  bool boundedRepair = false;  ///< Local search repairs with cost/hop bounded searches
+  unsigned int seed = std::random_device{}();  ///< Base seed of the worker RNG streams
+  std::shared_ptr<const SFPSnapshot> warmStart;  ///< Previous solution the first restart starts from
+  double timeLimitMs = 0.0;  ///< Wall-clock budget of solve() (0 disables)
+  double targetCost = -std::numeric_limits<double>::infinity();  ///< Stop once a solution this cheap is found
+  std::function<void(const Incumbent&)> onIncumbent;  ///< Called on every new global best, serialized
+  long long pathCacheEdges = ShortestPathCache::kDefaultMaxEdges;  ///< Budget of the shared path cache (0 disables)
+  int eliteSize = 0;     ///< Elite pool of path relinking (0 disables)
+  int relinkPeriod = 4;  ///< Restarts of a worker between two relinkings
+  int hubTopK = 0;                ///< Hubs tried per HubBreakingLocalSearch pass (0 tries all)
+  bool firstImprovement = false;  ///< HubBreakingLocalSearch passes end at their first accepted move
+  std::function<bool()> shouldStop;  ///< Polled with the time limit, true ends the run early
+  std::function<void(const Progress&)> onProgress;  ///< Called after every restart, serialized
+};
 
 /**
  * @class ConstructiveStrategy
@@ -16,6 +91,15 @@ class ConstructiveStrategy {
  public:
   virtual ~ConstructiveStrategy() = default;
   virtual SFPSolution generate(const SFPProblem* problem) = 0;
+
+  /**
+   * @brief Builds a new solution in place of `solution`, reusing its buffers
+   * when it belongs to the same problem.
+   */
+  virtual void generateInto(const SFPProblem* problem, SFPSolution& solution) {
+    solution = generate(problem);
+  }
+
   virtual std::string getName() const = 0;
 };
 
@@ -26,7 +110,14 @@ class ConstructiveStrategy {
 class LocalSearchStrategy {
  public:
   virtual ~LocalSearchStrategy() = default;
-  virtual bool optimize(SFPSolution* solution) = 0;
+
+  /**
+   * @brief One improvement pass.
+   * @param shouldStop Polled between moves, true ends the pass early with
+   * the moves applied so far.
+   * @return true if the solution improved.
+   */
+  virtual bool optimize(SFPSolution* solution, const std::function<bool()>& shouldStop = nullptr) = 0;
   virtual std::string getName() const = 0;
 };
 
@@ -44,54 +135,236 @@ class SolverStrategy {
 
 /**
  * @class GRASPConstructiveHeuristic
+ * @brief Randomized greedy construction over a Restricted Candidate List.
+ * * With `lazyCandidates` the CL is refreshed incrementally: only candidates
+ * the last accepted path could make cheaper are recomputed. Both rules build
+ * the same solution for the same RNG state.
+ * * An optional ShortestPathCache, shared by the restarts and workers of one
+ * problem, answers the pricings run before the first pair is connected; the
+ * solutions do not change.
  */
 class GRASPConstructiveHeuristic : public ConstructiveStrategy {
  private:
   float alpha;
+  bool lazyCandidates;
+  QueueKind queue;
   mutable std::shared_ptr<BidirectionalDijkstraEngine> dijkstra;
+  mutable std::shared_ptr<DijkstraEngine> explorer;
   std::mt19937& rng;
+  const SFPProblem* groupsProblem;  ///< Problem the cached terminal groups belong to
+  std::vector<std::vector<int>> terminalGroups;
+  std::shared_ptr<ShortestPathCache> pathCache;  ///< Built for the graph of the problems given
 
  public:
-  GRASPConstructiveHeuristic(std::mt19937& rng, std::shared_ptr<BidirectionalDijkstraEngine> externalDijkstra = nullptr, const float alpha = 1.0f) 
-      : alpha(alpha), dijkstra(externalDijkstra), rng(rng) {}
+  GRASPConstructiveHeuristic(std::mt19937& rng, std::shared_ptr<BidirectionalDijkstraEngine> externalDijkstra = nullptr,
+                             const float alpha = 1.0f, const bool lazyCandidates = true,
+                             const QueueKind queue = QueueKind::AUTO,
+                             std::shared_ptr<ShortestPathCache> pathCache = nullptr) 
+      : alpha(alpha), lazyCandidates(lazyCandidates), queue(queue), dijkstra(externalDijkstra), rng(rng),
+        groupsProblem(nullptr), pathCache(std::move(pathCache)) {}
 
   SFPSolution generate(const SFPProblem* problem) override;
+  void generateInto(const SFPProblem* problem, SFPSolution& solution) override;
   std::string getName() const override { return "GRASP" + std::to_string(alpha); }
 };
 
+/**
+ * @class WarmStartHeuristic
+ * @brief Rebuilds a previous solution on a (possibly changed) problem.
+ * * Snapshot pairs whose endpoints still belong to the same terminal group
+ * are kept, the others are dropped, and the groups left disconnected get new
+ * pairs from the problem terminal pairs. Recorded paths that still exist in
+ * the graph and join their pair are reinstalled as they are; only the rest is
+ * rerouted by shortest paths on the partial forest. Weight changes are picked
+ * up by the solution cost, the local search is left to decide on the paths.
+ * * Generation throws std::runtime_error if a pair cannot be reconnected.
+ */
+class WarmStartHeuristic : public ConstructiveStrategy {
+ private:
+  std::shared_ptr<const SFPSnapshot> snapshot;
+  QueueKind queue;
+  mutable std::shared_ptr<BidirectionalDijkstraEngine> dijkstra;
+  int keptPaths;
+  int repairedPaths;
+
+ public:
+  WarmStartHeuristic(std::shared_ptr<const SFPSnapshot> snapshot,
+                     std::shared_ptr<BidirectionalDijkstraEngine> externalDijkstra = nullptr,
+                     const QueueKind queue = QueueKind::AUTO)
+      : snapshot(std::move(snapshot)), queue(queue), dijkstra(externalDijkstra),
+        keptPaths(0), repairedPaths(0) {}
+
+  SFPSolution generate(const SFPProblem* problem) override;
+  void generateInto(const SFPProblem* problem, SFPSolution& solution) override;
+  std::string getName() const override { return "WARM_START"; }
+
+  /// Paths of the last generation reinstalled from the snapshot
+  int getKeptPaths() const { return keptPaths; }
+  /// Paths of the last generation rerouted (invalid paths and new pairs)
+  int getRepairedPaths() const { return repairedPaths; }
+};
+
 /**
  * @class GRASPLocalSearch
+ * @brief First-improvement edge drop: each edge active at the start of the
+ * pass is ditched, the pairs crossing it are rerouted, and the move is kept
+ * if the cost drops.
+ * * Drops are evaluated on a private copy of the edge state, without touching
+ * the solution, and only accepted ones are applied. With nThreads > 1 they
+ * are evaluated in batches by a thread pool, each worker on its own engine
+ * and state copy. The first improving drop of a batch is applied and the next
+ * batch starts right after it, so the visited moves and the result do not
+ * depend on the number of threads (engines must share the queue policy).
+ * * With `bounded`, repairs only look for paths cheaper than the edges the
+ * drop frees, under a hop limit widened when the search fails.
  */
 class GRASPLocalSearch : public LocalSearchStrategy {
  private:
+  struct DropScratch;
+
   mutable std::shared_ptr<BidirectionalDijkstraEngine> dijkstra;
+  int nThreads;
+  QueueKind queue;
+  bool bounded;
+  std::unique_ptr<ThreadPool> pool;
+  std::vector<std::unique_ptr<DropScratch>> scratch;
+  long long stateVersion;
 
  public:
-  GRASPLocalSearch(std::shared_ptr<BidirectionalDijkstraEngine> externalDijkstra = nullptr) 
-      : dijkstra(externalDijkstra) {}
+  GRASPLocalSearch(std::shared_ptr<BidirectionalDijkstraEngine> externalDijkstra = nullptr,
+                   const int nThreads = 1, const QueueKind queue = QueueKind::AUTO,
+                   const bool bounded = false);
+  ~GRASPLocalSearch();
 
-  bool optimize(SFPSolution* solution) override;
+  bool optimize(SFPSolution* solution, const std::function<bool()>& shouldStop = nullptr) override;
   std::string getName() const override { return "GRASP_LS"; }
 };
 
 /**
- * @class KeyPathLocalSearch
+ * @class HubBreakingLocalSearch
+ * @brief Breaks hubs (nodes with 3 active edges or more) by dropping all of
+ * their active edges and rerouting the pairs that used them.
+ * * A pass reads the hub set the solution keeps through insert/erase and
+ * ranks the hubs by instability (active edge cost over the mean synergy of
+ * their pairs) in a heap popped lazily, so it costs the active subgraph, not
+ * the graph. A popped hub is tried with its current edges and skipped if an
+ * earlier move left it with less than 3. `topK` bounds the hubs tried per
+ * pass and `firstImprovement` ends the pass at the first accepted move.
  */
 class HubBreakingLocalSearch : public LocalSearchStrategy {
  private:
+  struct HubScratch;
+
   mutable std::shared_ptr<BidirectionalDijkstraEngine> dijkstra;
+  bool bounded;  ///< Bounded repairs, as in GRASPLocalSearch
+  int topK;
+  bool firstImprovement;
+  std::unique_ptr<HubScratch> scratch;
 
  public:
-  HubBreakingLocalSearch(std::shared_ptr<BidirectionalDijkstraEngine> externalDijkstra = nullptr) 
-      : dijkstra(externalDijkstra) {}
+  /**
+   * @param topK Hubs tried per pass, the most unstable first (0 tries all).
+   * @param firstImprovement Ends a pass at its first accepted move.
+   */
+  HubBreakingLocalSearch(std::shared_ptr<BidirectionalDijkstraEngine> externalDijkstra = nullptr,
+                         const bool bounded = false, const int topK = 0,
+                         const bool firstImprovement = false);
+  ~HubBreakingLocalSearch();
 
-  bool optimize(SFPSolution* solution) override;
+  bool optimize(SFPSolution* solution, const std::function<bool()>& shouldStop = nullptr) override;
   std::string getName() const override { return "GRASP_LS"; }
 };
 
+/**
+ * @class EliteSet
+ * @brief Shared pool of the best distinct local optima of a run.
+ * * Members are kept as snapshots sorted by cost, with their edge sets
+ * (lower id of each twin, sorted) to measure how far apart two solutions
+ * are. A candidate with the same edge set as a member can only replace it if
+ * cheaper. Otherwise it joins while the pool has room; once full it must beat
+ * the worst member and replaces, among the members no cheaper than it, the
+ * one closest to it, which keeps the pool diverse. Thread-safe.
+ */
+class EliteSet {
+ private:
+  struct Member {
+    SFPSnapshot snapshot;
+    std::vector<int> edges;
+  };
+
+  mutable std::mutex mutex;
+  int capacity;
+  std::vector<Member> members;
+
+ public:
+  explicit EliteSet(const int capacity) : capacity(std::max(1, capacity)) {}
+
+  /**
+   * @return Whether the solution entered the pool.
+   */
+  bool offer(const SFPSolution& solution);
+
+  /**
+   * @brief Copies into `guide` a random member whose edge set differs from
+   * the solution's, drawn with `rng`.
+   * @return false if there is none.
+   */
+  bool pickGuide(const SFPSolution& solution, std::mt19937& rng, SFPSnapshot& guide) const;
+
+  int size() const;
+  double bestCost() const;
+
+  /// Number of edges in one set and not in the other (both sorted)
+  static int distance(const std::vector<int>& a, const std::vector<int>& b);
+};
+
+/**
+ * @class PathRelinking
+ * @brief Walks a solution toward a guide solution, one pair at a time.
+ * * Each pair is given the path that joins its terminals inside the edges of
+ * the guide (shortest one in that subgraph). At every step the pair whose
+ * reroute toward the guide is the cheapest, priced by evaluateReroute, is
+ * switched with SFPMove; the walk ends when every pair follows the guide. The
+ * solution is left at the cheapest solution met after the first step, as a
+ * starting point for the local search.
+ */
+class PathRelinking {
+ private:
+  std::shared_ptr<BidirectionalDijkstraEngine> dijkstra;
+  QueueKind queue;
+  EdgeMask guideState;  ///< Everything but the guide edges is a ditch
+  SFPSnapshot best;
+
+ public:
+  PathRelinking(std::shared_ptr<BidirectionalDijkstraEngine> externalDijkstra = nullptr,
+                const QueueKind queue = QueueKind::AUTO)
+      : dijkstra(std::move(externalDijkstra)), queue(queue) {}
+
+  /**
+   * @return Number of steps walked; 0 leaves the solution untouched.
+   */
+  int relink(SFPSolution& solution, const SFPSnapshot& guide);
+};
+
 /**
  * @class Metaheuristics
  * @brief Template solver strategy capable of dynamically combining any Constructive and Local Search.
+ * * Restarts are split round-robin among `nThreads` workers. Each worker owns
+ * its Dijkstra engine, RNG stream and strategies, so the result only depends
+ * on the seed and the number of threads.
+ * * With a warm start, the first restart rebuilds that solution instead of
+ * constructing one, so a single iteration is a local search of it.
+ * * Anytime mode: the time limit, the target cost and shouldStop are checked between
+ * restarts and inside the local search passes, between drop batches and between
+ * hubs, so a stop waits for one move evaluation at most. A stopped restart still competes
+ * with the cost it reached, and worker 0 always completes the construction of
+ * its first restart, so solve() returns a solution even on a tiny budget.
+ * Results under a time limit depend on the machine load.
+ * * With an elite pool, every local optimum is offered to an EliteSet shared
+ * by the workers, and every `relinkPeriod` restarts of a worker its local
+ * optimum is relinked toward a random elite member; the best intermediate
+ * solution goes through the local search and competes as a restart of its
+ * own. The pool makes runs with several threads depend on their timing.
  */
 template <typename LocalSearch>
 class Metaheuristics : public SolverStrategy {
@@ -99,40 +372,178 @@ class Metaheuristics : public SolverStrategy {
                 "METAHEURISTIC_ERROR: LocalSearch type must inherit from LocalSearchStrategy.");
 
  private:
+  /**
+   * @struct Worker
+   * @brief Private state of one restart thread.
+   */
+  struct Worker {
+    std::mt19937 rng;
+    std::unique_ptr<GRASPConstructiveHeuristic> constructive;
+    std::unique_ptr<WarmStartHeuristic> warmStart;  ///< Worker 0 only, with config.warmStart
+    std::unique_ptr<LocalSearch> localSearch;
+    std::unique_ptr<PathRelinking> relinking;  ///< With config.eliteSize
+  };
+
   const SFPProblem* problem;
+  SolverConfig config;
   mutable double firstCost;
-  int maxIterations;
-  mutable std::mt19937 rng;
-  std::unique_ptr<GRASPConstructiveHeuristic> constructive;
-  std::unique_ptr<LocalSearch> localSearch;
+  std::vector<std::unique_ptr<Worker>> workers;
 
  public:
-    Metaheuristics(SFPProblem* problem, const int maxIter = 1, const float alpha = 1.0f) 
-        : problem(problem), firstCost(-1.0f), maxIterations(maxIter) {
-       std::random_device rd;
-       rng.seed(rd());
-       auto dijkstra = std::make_shared<BidirectionalDijkstraEngine>(problem->getGraphPtr()); 
-       
-       constructive = std::make_unique<GRASPConstructiveHeuristic>(rng, dijkstra, alpha); 
-       localSearch = std::make_unique<LocalSearch>(dijkstra); 
+    /**
+     * @param resources Optional objects kept across runs of the same problem
+     * (see SolverResources), filled with what this run builds.
+     */
+    Metaheuristics(const SFPProblem* problem, const SolverConfig& config = {},
+                   std::shared_ptr<SolverResources> resources = nullptr) 
+        : problem(problem), config(config), firstCost(-1.0f) {
+       int nWorkers = std::max(1, std::min(config.nThreads, config.maxIterations));
+       if (!resources) resources = std::make_shared<SolverResources>();
+
+       // ALT tables are read-only, so all workers share them
+       std::shared_ptr<const Landmarks>& landmarks = resources->landmarks;
+       if (config.nLandmarks > 0 && !landmarks)
+         landmarks = std::make_shared<const Landmarks>(problem->getGraphPtr(), config.nLandmarks);
+
+       // Restarts keep pricing the same terminal pairs on the empty solution
+       std::shared_ptr<ShortestPathCache> pathCache;
+       if (config.pathCacheEdges > 0) {
+         if (!resources->pathCache) resources->pathCache = std::make_shared<ShortestPathCache>(config.pathCacheEdges);
+         pathCache = resources->pathCache;
+       }
+
+       auto& engines = resources->engines;
+       for (int w = 0; w < nWorkers; w++) {
+         auto worker = std::make_unique<Worker>();
+         std::seed_seq seq{config.seed, static_cast<unsigned int>(w)};
+         worker->rng.seed(seq);
+
+         if (static_cast<int>(engines.size()) <= w)
+           engines.push_back(BidirectionalDijkstraEngine::create(problem->getGraphPtr(), landmarks, config.queue));
+         auto dijkstra = engines[w];
+         worker->constructive = std::make_unique<GRASPConstructiveHeuristic>(
+             worker->rng, dijkstra, config.alpha, true, config.queue, pathCache); 
+         if (w == 0 && config.warmStart)
+           worker->warmStart = std::make_unique<WarmStartHeuristic>(config.warmStart, dijkstra, config.queue);
+         if constexpr (std::is_same_v<LocalSearch, GRASPLocalSearch>)
+           worker->localSearch = std::make_unique<LocalSearch>(dijkstra, config.lsThreads, config.queue,
+                                                               config.boundedRepair);
+         else
+           worker->localSearch = std::make_unique<LocalSearch>(dijkstra, config.boundedRepair, config.hubTopK,
+                                                               config.firstImprovement); 
+         if (config.eliteSize > 0)
+           worker->relinking = std::make_unique<PathRelinking>(dijkstra, config.queue);
+         workers.push_back(std::move(worker));
+       }
     }
 
     SFPSolution solve() const override {
-        SFPSolution best = constructive->generate(problem);
-        firstCost = best.getCurrentCost();
-        
-        while (localSearch->optimize(&best));
-        
-        for(int it = 1; it < maxIterations; it++){
-            SFPSolution temp = constructive->generate(problem);
-            while (localSearch->optimize(&temp));
-            if(best.getCurrentCost() > temp.getCurrentCost()) best = temp;
-        }
-
-        return best;
+        const int nWorkers = workers.size();
+        // Workers keep a snapshot of their best restart, cheap to overwrite
+        std::vector<SFPSnapshot> bests(nWorkers);
+        std::vector<std::exception_ptr> errors(nWorkers);
+        std::atomic<double> globalBest(std::numeric_limits<double>::infinity());
+
+        using Clock = std::chrono::steady_clock;
+        const auto start = Clock::now();
+        auto elapsedMs = [&] { return std::chrono::duration<double, std::milli>(Clock::now() - start).count(); };
+        std::atomic<bool> stop(false);
+        auto stopped = [&] {
+          if (stop.load(std::memory_order_relaxed)) return true;
+          if (config.shouldStop && config.shouldStop()) {
+            stop.store(true, std::memory_order_relaxed);
+            return true;
+          }
+          if (config.timeLimitMs <= 0.0 || elapsedMs() < config.timeLimitMs) return false;
+          stop.store(true, std::memory_order_relaxed);
+          return true;
+        };
+
+        // Incumbents are reported in decreasing cost order
+        std::mutex incumbentMutex;
+        double reported = std::numeric_limits<double>::infinity();
+        int completed = 0;
+        auto progress = [&] {
+          if (!config.onProgress) return;
+          std::lock_guard<std::mutex> lock(incumbentMutex);
+          config.onProgress({++completed, config.maxIterations, globalBest.load(std::memory_order_relaxed), elapsedMs()});
+        };
+
+        std::unique_ptr<EliteSet> elite;
+        if (config.eliteSize > 0) elite = std::make_unique<EliteSet>(config.eliteSize);
+
+        auto run = [&](const int w) {
+          try {
+            Worker& worker = *workers[w];
+            // Every restart is built into the same solution buffer
+            SFPSolution temp = problem->empty_solution();
+            SFPSnapshot guide;
+
+            auto record = [&](const int it) {
+              // A restart worse than the global incumbent can never be returned
+              double cost = temp.getCurrentCost();
+              if (cost > globalBest.load(std::memory_order_relaxed)) return;
+              if (bests[w].cost <= cost) return;
+              bests[w].capture(temp);
+
+              double seen = globalBest.load(std::memory_order_relaxed);
+              while (cost < seen && !globalBest.compare_exchange_weak(seen, cost, std::memory_order_relaxed));
+              if (cost <= config.targetCost) stop.store(true, std::memory_order_relaxed);
+
+              if (config.onIncumbent) {
+                std::lock_guard<std::mutex> lock(incumbentMutex);
+                if (cost < reported) {
+                  reported = cost;
+                  config.onIncumbent({&temp, cost, elapsedMs(), it});
+                }
+              }
+            };
+
+            int restarts = 0;
+            for (int it = w; it < config.maxIterations; it += nWorkers) {
+              if (it > 0 && stopped()) break;
+              if (it == 0 && worker.warmStart) worker.warmStart->generateInto(problem, temp);
+              else worker.constructive->generateInto(problem, temp);
+              if (it == 0) firstCost = temp.getCurrentCost();
+
+              while (!stopped() && worker.localSearch->optimize(&temp, stopped));
+              record(it);
+              progress();
+
+              if (!elite) continue;
+              elite->offer(temp);
+              if (++restarts % std::max(1, config.relinkPeriod) != 0 || stopped()) continue;
+              if (!elite->pickGuide(temp, worker.rng, guide)) continue;
+              if (worker.relinking->relink(temp, guide) == 0) continue;
+
+              while (!stopped() && worker.localSearch->optimize(&temp, stopped));
+              record(it);
+              elite->offer(temp);
+            }
+          } catch (...) {
+            errors[w] = std::current_exception();
+          }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(nWorkers - 1);
+        for (int w = 1; w < nWorkers; w++) threads.emplace_back(run, w);
+        run(0);
+        for (auto& thread : threads) thread.join();
+
+        for (const auto& error : errors)
+          if (error) std::rethrow_exception(error);
+
+        // Deterministic reduction: lowest cost, ties broken by worker index
+        int winner = -1;
+        for (int w = 0; w < nWorkers; w++)
+          if (bests[w].captured() && (winner == -1 || bests[w].cost < bests[winner].cost))
+            winner = w;
+
+        return bests[winner].toSolution(problem);
     }
     double getFirstCost() const override { return firstCost; }
-    std::string getName() const override { return constructive->getName() + "-" + localSearch->getName() + "-SFP"; }
+    std::string getName() const override { return workers[0]->constructive->getName() + "-" + workers[0]->localSearch->getName() + "-SFP"; }
 };
 
 #endif
@@ -0,0 +1,236 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+#include "../utils/ThreadPool.hpp"
+#include "Batch.hpp"
+
+namespace {
+
+/**
+ * @struct InstanceSlot
+ * @brief Problem and solver resources shared by the jobs of one instance.
+ * * All jobs run with the same queue and number of landmarks, so the idle
+ * resources of finished jobs fit any later job of the instance.
+ */
+struct InstanceSlot {
+  std::once_flag loaded;
+  std::shared_ptr<const SFPProblem> problem;
+  std::string error;
+  std::atomic<int> remaining{0};  ///< Jobs not finished yet
+
+  std::mutex poolMutex;
+  std::shared_ptr<const Landmarks> landmarks;
+  std::shared_ptr<ShortestPathCache> pathCache;
+  std::vector<std::shared_ptr<SolverResources>> idle;
+
+  /// Idle resources of a finished job, or a new set on the shared tables
+  std::shared_ptr<SolverResources> acquire() {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    if (!idle.empty()) {
+      auto resources = std::move(idle.back());
+      idle.pop_back();
+      return resources;
+    }
+    auto resources = std::make_shared<SolverResources>();
+    resources->landmarks = landmarks;
+    resources->pathCache = pathCache;
+    return resources;
+  }
+
+  void release(std::shared_ptr<SolverResources> resources) {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    if (!landmarks) landmarks = resources->landmarks;
+    if (!pathCache) pathCache = resources->pathCache;
+    idle.push_back(std::move(resources));
+  }
+
+  void free() {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    problem.reset();
+    landmarks.reset();
+    pathCache.reset();
+    idle.clear();
+  }
+};
+
+std::string jsonEscape(const std::string& text) {
+  static const char hex[] = "0123456789abcdef";
+  std::string escaped;
+  escaped.reserve(text.size());
+  for (char c : text) {
+    switch (c) {
+      case '"': escaped += "\\\""; break;
+      case '\\': escaped += "\\\\"; break;
+      case '\n': escaped += "\\n"; break;
+      case '\r': escaped += "\\r"; break;
+      case '\t': escaped += "\\t"; break;
+      default:
+        // Other control characters are not allowed raw in JSON strings
+        if (static_cast<unsigned char>(c) < 0x20) {
+          escaped += "\\u00";
+          escaped += hex[(c >> 4) & 0xf];
+          escaped += hex[c & 0xf];
+        } else {
+          escaped += c;
+        }
+    }
+  }
+  return escaped;
+}
+
+std::string csvField(const std::string& text) {
+  if (text.find_first_of(",\"\n") == std::string::npos) return text;
+  std::string quoted = "\"";
+  for (char c : text) {
+    if (c == '"') quoted += '"';
+    quoted += c == '\n' ? ' ' : c;
+  }
+  return quoted + "\"";
+}
+
+}  // namespace
+
+BatchRunner::BatchRunner(SolverConfig base, const int nJobs)
+    : base(std::move(base)), nJobs(std::max(1, nJobs)) {}
+
+std::vector<std::string> BatchRunner::listInstances(const std::string& source) {
+  namespace fs = std::filesystem;
+  auto isInstance = [](const fs::path& path) {
+    return path.extension() == ".stp" || path.extension() == ".sfpb";
+  };
+
+  std::vector<std::string> instances;
+  if (fs::is_directory(source)) {
+    for (const auto& entry : fs::recursive_directory_iterator(source))
+      if (entry.is_regular_file() && isInstance(entry.path())) instances.push_back(entry.path().string());
+    std::sort(instances.begin(), instances.end());
+    return instances;
+  }
+
+  std::ifstream manifest(source);
+  if (!manifest.is_open()) throw std::runtime_error("\tThe batch source cannot be opened: " + source);
+
+  const fs::path base = fs::path(source).parent_path();
+  std::string line;
+  int lineNumber = 0;
+  while (std::getline(manifest, line)) {
+    lineNumber++;
+    size_t first = line.find_first_not_of(" \t\r");
+    if (first == std::string::npos || line[first] == '#') continue;
+    size_t last = line.find_last_not_of(" \t\r");
+    fs::path path = line.substr(first, last - first + 1);
+    if (path.is_relative()) path = base / path;
+    if (!fs::is_regular_file(path))
+      throw std::runtime_error("\tLine " + std::to_string(lineNumber) + ": missing instance " + path.string());
+    instances.push_back(path.string());
+  }
+  return instances;
+}
+
+void BatchRunner::run(const std::vector<std::string>& instances,
+                      const std::vector<std::string>& algorithms,
+                      const std::vector<unsigned int>& seeds,
+                      const std::function<void(const BatchResult&)>& onResult) const {
+  const int perInstance = algorithms.size() * seeds.size();
+  if (instances.empty() || perInstance == 0) return;
+
+  std::vector<InstanceSlot> slots(instances.size());
+  for (auto& slot : slots) slot.remaining = perInstance;
+
+  std::mutex outputMutex;
+  auto job = [&](const int task, int) {
+    InstanceSlot& slot = slots[task / perInstance];
+    const std::string& path = instances[task / perInstance];
+
+    BatchResult result;
+    result.instance = path;
+    result.algorithm = algorithms[(task % perInstance) / seeds.size()];
+    result.seed = seeds[task % seeds.size()];
+
+    std::call_once(slot.loaded, [&] {
+      try {
+        auto problem = std::make_shared<SFPProblem>();
+        problem->loadFile(path);
+        slot.problem = std::move(problem);
+      } catch (const std::exception& e) {
+        slot.error = e.what();
+      }
+    });
+    std::shared_ptr<const SFPProblem> problem = slot.problem;
+
+    std::shared_ptr<SolverResources> resources;
+    try {
+      if (!problem) throw std::runtime_error(slot.error);
+      result.nNodes = problem->getNNodes();
+      result.nEdges = problem->getNEdges();
+      result.nTerminals = problem->getTerminals().size();
+
+      SolverConfig config = base;
+      config.seed = result.seed;
+      resources = slot.acquire();
+      auto start = std::chrono::steady_clock::now();
+      if (result.algorithm == "CONSTRUCTIVE") {
+        std::mt19937 rng(config.seed);
+        if (config.nLandmarks > 0 && !resources->landmarks)
+          resources->landmarks = std::make_shared<const Landmarks>(problem->getGraphPtr(), config.nLandmarks);
+        if (resources->engines.empty())
+          resources->engines.push_back(
+              BidirectionalDijkstraEngine::create(problem->getGraphPtr(), resources->landmarks, config.queue));
+        GRASPConstructiveHeuristic constructive(rng, resources->engines[0], config.alpha, true, config.queue);
+        SFPSolution solution = constructive.generate(problem.get());
+        result.firstCost = result.cost = solution.getCurrentCost();
+        result.feasible = solution.isFeasible();
+      } else {
+        std::unique_ptr<SolverStrategy> solver;
+        if (result.algorithm == "GRASP")
+          solver = std::make_unique<Metaheuristics<GRASPLocalSearch>>(problem.get(), config, resources);
+        else if (result.algorithm == "HUB")
+          solver = std::make_unique<Metaheuristics<HubBreakingLocalSearch>>(problem.get(), config, resources);
+        else throw std::runtime_error("\tUnknown algorithm: " + result.algorithm);
+        SFPSolution solution = solver->solve();
+        result.firstCost = solver->getFirstCost();
+        result.cost = solution.getCurrentCost();
+        result.feasible = solution.isFeasible();
+      }
+      result.timeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+      slot.release(std::move(resources));
+    } catch (const std::exception& e) {
+      // Engines of a failed run may be mid-search, they are not reused
+      result.error = e.what();
+    }
+
+    // The last job of an instance frees it
+    problem.reset();
+    if (--slot.remaining == 0) slot.free();
+
+    std::lock_guard<std::mutex> lock(outputMutex);
+    onResult(result);
+  };
+
+  ThreadPool pool(nJobs);
+  pool.parallelFor(instances.size() * perInstance, job);
+}
+
+void BatchRunner::writeCSVHeader(std::ostream& out) {
+  out << "instance,algorithm,seed,first_cost,cost,time_ms,feasible,nodes,edges,terminals,error\n";
+}
+
+void BatchRunner::writeCSV(std::ostream& out, const BatchResult& r) {
+  out << csvField(r.instance) << ',' << r.algorithm << ',' << r.seed << ',' << r.firstCost << ','
+      << r.cost << ',' << r.timeMs << ',' << r.feasible << ',' << r.nNodes << ',' << r.nEdges << ','
+      << r.nTerminals << ',' << csvField(r.error) << '\n' << std::flush;
+}
+
+void BatchRunner::writeJSON(std::ostream& out, const BatchResult& r) {
+  out << "{\"instance\": \"" << jsonEscape(r.instance) << "\", \"algorithm\": \"" << r.algorithm
+      << "\", \"seed\": " << r.seed << ", \"first_cost\": " << r.firstCost << ", \"cost\": " << r.cost
+      << ", \"time_ms\": " << r.timeMs << ", \"feasible\": " << (r.feasible ? "true" : "false")
+      << ", \"nodes\": " << r.nNodes << ", \"edges\": " << r.nEdges << ", \"terminals\": " << r.nTerminals
+      << ", \"error\": \"" << jsonEscape(r.error) << "\"}\n" << std::flush;
+}
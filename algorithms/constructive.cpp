@@ -1,3 +1,4 @@
+#include <stdexcept>
 #include <unordered_map>
 
 #include "../utils/DSU.hpp"
@@ -5,36 +6,37 @@
 
 /**
  * @brief Agglutinates terminal sets that share vertices.
+ * * Only the terminals are touched, and groups come out ordered by their
+ * smallest terminal, whatever roots the DSU picks.
  */
 static std::vector<std::vector<int>> preprocessTerminalGroups(
     int nNodes, const std::vector<std::pair<int, int>>& terminals) {
-  DSU dsu(nNodes);
+  SparseDSU dsu(nNodes);
 
   // Union sets for pairs defined in the input
-  for (const auto& p : terminals) dsu.unite(p.first, p.second);
-
-  // Group vertices by connected component (Root -> List of Nodes)
-  std::unordered_map<int, std::vector<int>> groupsMap;
-  std::vector<bool> isTerminal(nNodes, false);
-
+  std::vector<int> nodes;
+  nodes.reserve(2 * terminals.size());
   for (const auto& p : terminals) {
-    isTerminal[p.first] = true;
-    isTerminal[p.second] = true;
+    dsu.unite(p.first, p.second);
+    nodes.push_back(p.first);
+    nodes.push_back(p.second);
   }
+  std::sort(nodes.begin(), nodes.end());
+  nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
 
-  for (int i = 0; i < nNodes; ++i)
-    if (isTerminal[i]) {
-      int root = dsu.find(i);
-      groupsMap[root].push_back(i);
-    }
-
-  // Convert map to vector of vectors
+  // Group vertices by connected component (Root -> List of Nodes)
+  std::unordered_map<int, int> groupOf;
   std::vector<std::vector<int>> groupedTerminals;
-  groupedTerminals.reserve(groupsMap.size());
-  for (auto& entry : groupsMap)
-    if (entry.second.size() > 1)
-      groupedTerminals.push_back(std::move(entry.second));
+  for (int v : nodes) {
+    auto [it, added] = groupOf.try_emplace(dsu.find(v), groupedTerminals.size());
+    if (added) groupedTerminals.emplace_back();
+    groupedTerminals[it->second].push_back(v);
+  }
 
+  groupedTerminals.erase(
+      std::remove_if(groupedTerminals.begin(), groupedTerminals.end(),
+                     [](const std::vector<int>& group) { return group.size() < 2; }),
+      groupedTerminals.end());
   return groupedTerminals;
 }
 
@@ -43,8 +45,7 @@ static std::vector<std::vector<int>> preprocessTerminalGroups(
  * Randomly pairs up terminals within each group until one remains.
  */
 static std::vector<SolutionPair> generatePairs(
-    const std::vector<std::vector<int>>& terminalGroups, const int nTerm,
-    std::mt19937& rng) {
+    const std::vector<std::vector<int>>& terminalGroups, std::mt19937& rng) {
   std::vector<SolutionPair> pairs;
 
   for (const auto& groupConst : terminalGroups) {
@@ -66,7 +67,7 @@ static std::vector<SolutionPair> generatePairs(
       int idxDest = distDest(rng);
       int dest = group[idxDest];
 
-      pairs.push_back({pivot, dest, nTerm});
+      pairs.push_back({pivot, dest});
     }
   }
 
@@ -80,72 +81,303 @@ static std::vector<SolutionPair> generatePairs(
 struct Candidate {
   int pair_id;
   double cost;
+  int step;  ///< Construction step in which the path was computed
   std::vector<int> path;
 
-  Candidate(const int pair_id) : pair_id(pair_id), cost(0.0) {}
-
-  bool operator<(const Candidate& other) const { return cost < other.cost; }
+  Candidate(const int pair_id) : pair_id(pair_id), cost(0.0), step(0) {}
 };
 
+/**
+ * @brief Groups candidates by a shared endpoint for one-to-many pricing.
+ * Endpoints are taken by decreasing number of candidates, each candidate
+ * joining the first group that can hold it.
+ * @return {endpoint, candidate ids} per group.
+ */
+static std::vector<std::pair<int, std::vector<int>>> groupByEndpoint(
+    const std::vector<SolutionPair>& pairs, const std::vector<int>& ids) {
+  std::unordered_map<int, std::vector<int>> byEndpoint;
+  for (int id : ids) {
+    byEndpoint[pairs[id].source].push_back(id);
+    byEndpoint[pairs[id].target].push_back(id);
+  }
+
+  std::vector<std::pair<int, std::vector<int>>> endpoints(byEndpoint.begin(), byEndpoint.end());
+  std::sort(endpoints.begin(), endpoints.end(), [](const auto& a, const auto& b) {
+    return a.second.size() != b.second.size() ? a.second.size() > b.second.size()
+                                              : a.first < b.first;
+  });
+
+  std::vector<char> grouped(pairs.size(), 0);
+  std::vector<std::pair<int, std::vector<int>>> groups;
+  for (auto& [endpoint, members] : endpoints) {
+    std::vector<int> group;
+    for (int id : members)
+      if (!grouped[id]) {
+        grouped[id] = 1;
+        group.push_back(id);
+      }
+    if (!group.empty()) groups.push_back({endpoint, std::move(group)});
+  }
+  return groups;
+}
+
+/// Candidates sharing an endpoint from which one search beats single queries
+static constexpr int kBatchMinTargets = 3;
+
+/// CL size under which the lazy rule falls back to eager refreshes
+static constexpr int kEagerRefreshBelow = 16;
+
 /**
  * @brief Executes the GRASP Constructive Heuristic.
+ * * The CL is kept as an ordered index of (cost, pair_id) keys. On the eager
+ * rule every candidate is recomputed after each accepted pair. On the lazy
+ * rule the accepted path P becomes a zero-cost hub: the new cost of a
+ * candidate is min(cost, dist(source, P) + dist(P, target)), so a single
+ * multi-source expansion from P, bounded by the costliest candidate, refreshes
+ * every cost. Paths are only computed for the selected candidate, on the
+ * current bitmask, so both rules build the same solution.
+ * * Full pricings (initial CL, eager refreshes) settle the candidates that
+ * share an endpoint with one one-to-many search from it.
  */
 SFPSolution GRASPConstructiveHeuristic::generate(const SFPProblem* problem) {
+  SFPSolution solution = problem->empty_solution();
+  generateInto(problem, solution);
+  return solution;
+}
+
+void GRASPConstructiveHeuristic::generateInto(const SFPProblem* problem, SFPSolution& solution) {
+  SFP_STAT_TIMER(CONSTRUCTIVE);
   if (!dijkstra)
-    dijkstra =
-        std::make_shared<BidirectionalDijkstraEngine>(problem->getGraphPtr());
+    dijkstra = BidirectionalDijkstraEngine::create(problem->getGraphPtr(), nullptr, queue);
+  if (!explorer)
+    explorer = DijkstraEngine::create(problem->getGraphPtr(), queue);
 
-  // Generate Pairs
-  auto groups =
-      preprocessTerminalGroups(problem->getNNodes(), problem->getTerminals());
-  auto rawPairs = generatePairs(groups, problem->getTerminals().size(), rng);
+  // Generate Pairs, the groups only depend on the problem
+  if (groupsProblem != problem) {
+    terminalGroups = preprocessTerminalGroups(problem->getNNodes(), problem->getTerminals());
+    groupsProblem = problem;
+  }
+  const auto dictPairs = generatePairs(terminalGroups, rng);
 
-  std::vector<SolutionPair> dictPairs = rawPairs;
-  SFPSolution solution(problem, std::move(rawPairs));
+  if (solution.getProblem() != problem) solution = problem->empty_solution();
+  solution.reinit(dictPairs);
+  const auto& graphEdges = problem->getGraphPtr()->edges;
 
   // Initialize Candidate List (CL)
   std::vector<Candidate> CL;
   CL.reserve(dictPairs.size());
+  std::vector<std::pair<double, int>> order;
+  order.reserve(dictPairs.size());
 
-  for (int i = 0; i < static_cast<int>(dictPairs.size()); ++i) {
-    Candidate cand(i);
-    auto result = dijkstra->getShortPath(
-        dictPairs[i].source, dictPairs[i].target, solution.getBitmask());
+  int step = 0;
+  auto reroute = [&](Candidate& cand) {
+    const int source = dictPairs[cand.pair_id].source, target = dictPairs[cand.pair_id].target;
+    // Without bridges the engine may use its landmark potential
+    std::pair<std::vector<int>, float> result;
+    if (solution.getNEdges()) {
+      result = dijkstra->getShortPath(source, target, solution.getBitmask());
+    } else if (!pathCache || !pathCache->findPath(source, target, result)) {
+      result = dijkstra->getShortPath(source, target, nullptr);
+      if (pathCache) pathCache->storePath(source, target, result);
+    }
     cand.path = std::move(result.first);
     cand.cost = result.second;
-    CL.push_back(std::move(cand));
+    cand.step = step;
+  };
+
+  // Prices candidates sharing an endpoint with one one-to-many search. Only
+  // the cost is kept (step -1): the path of the selected candidate is always
+  // recomputed by the bidirectional engine, so ties break as for single pairs.
+  // A search reaches the same distance whatever the other targets, so on the
+  // empty solution only the uncached ones are searched
+  std::vector<int> others;
+  std::vector<int> misses;
+  auto price = [&](const std::vector<int>& ids) {
+    const bool cached = pathCache && !solution.getNEdges();
+    for (const auto& [endpoint, members] : groupByEndpoint(dictPairs, ids)) {
+      if (static_cast<int>(members.size()) < kBatchMinTargets) {
+        for (int id : members) reroute(CL[id]);
+        continue;
+      }
+      others.clear();
+      misses.clear();
+      for (int id : members) {
+        Candidate& cand = CL[id];
+        int other = dictPairs[id].source == endpoint ? dictPairs[id].target : dictPairs[id].source;
+        cand.path.clear();
+        cand.step = -1;
+        float cost;
+        if (cached && pathCache->findCost(endpoint, other, cost)) {
+          cand.cost = cost;
+          continue;
+        }
+        others.push_back(other);
+        misses.push_back(id);
+      }
+      if (others.empty()) continue;
+
+      auto costs = explorer->getShortPaths(endpoint, others,
+                                           solution.getNEdges() ? solution.getBitmask() : nullptr);
+      for (size_t k = 0; k < misses.size(); ++k) {
+        CL[misses[k]].cost = costs[k];
+        if (cached) pathCache->storeCost(endpoint, others[k], costs[k]);
+      }
+    }
+  };
+
+  std::vector<int> ids;
+  for (int i = 0; i < static_cast<int>(dictPairs.size()); ++i) {
+    CL.emplace_back(i);
+    ids.push_back(i);
   }
+  price(ids);
+  for (int i = 0; i < static_cast<int>(dictPairs.size()); ++i) order.push_back({CL[i].cost, i});
 
-  // While |CL| > 0
-  while (!CL.empty()) {
-    // CL <- Sort(CL)
-    std::sort(CL.begin(), CL.end());
+  // CL <- Sort(CL)
+  std::sort(order.begin(), order.end());
+
+  std::vector<int> pathNodes;
 
+  // While |CL| > 0
+  while (!order.empty()) {
     // RCL <- CL * alpha
-    int rclSize = std::max(1, static_cast<int>(CL.size() * alpha));
+    int rclSize = std::max(1, static_cast<int>(order.size() * alpha));
 
     // Select random candidate from RCL
     std::uniform_int_distribution<int> distRCL(0, rclSize - 1);
     int selectedIdx = distRCL(rng);
+    Candidate& selected = CL[order[selectedIdx].second];
+
+    // Stale paths have the right cost but may differ on ties
+    if (selected.step != step) reroute(selected);
 
     // Apply the connection using our safe ConnectPairMove
-    SFPMove move(&solution, MoveType::CNCT_PAIR, CL[selectedIdx].pair_id,
-                 std::move(CL[selectedIdx].path));
+    SFPMove move(&solution, MoveType::CNCT_PAIR, selected.pair_id,
+                 std::move(selected.path));
     move.apply();
 
-    // CL <- CL - {P} (O(1) removal technique)
-    CL[selectedIdx] = std::move(CL.back());
-    CL.pop_back();
-
-    // Update costs and paths in CL using Dijkstra
-    for (auto& cand : CL) {
-      auto result = dijkstra->getShortPath(dictPairs[cand.pair_id].source,
-                                           dictPairs[cand.pair_id].target,
-                                           solution.getBitmask());
-      cand.path = std::move(result.first);
-      cand.cost = result.second;
+    // CL <- CL - {P}
+    order.erase(order.begin() + selectedIdx);
+    step++;
+
+    // A single bidirectional query is far cheaper than a whole-radius
+    // expansion, so short lists are refreshed eagerly
+    if (!lazyCandidates || static_cast<int>(order.size()) < kEagerRefreshBelow) {
+      // Update costs and paths in CL using Dijkstra
+      ids.clear();
+      for (const auto& key : order) ids.push_back(key.second);
+      price(ids);
+      for (auto& key : order) key.first = CL[key.second].cost;
+      std::sort(order.begin(), order.end());
+      continue;
+    }
+
+    // Distances from the accepted path, bounded by the costliest candidate
+    pathNodes.clear();
+    for (int edge_id : move.connectedEdges) {
+      pathNodes.push_back(graphEdges[edge_id].source);
+      pathNodes.push_back(graphEdges[edge_id].target);
+    }
+    explorer->exploreFrom(pathNodes, solution.getBitmask(), order.back().first);
+
+    for (int k = 0; k < static_cast<int>(order.size()); ++k) {
+      Candidate& cand = CL[order[k].second];
+      double viaPath = explorer->getDistance(dictPairs[cand.pair_id].source) +
+                       explorer->getDistance(dictPairs[cand.pair_id].target);
+      if (viaPath >= cand.cost) continue;
+
+      // Costs only decrease, so the key moves towards the front
+      cand.cost = viaPath;
+      std::pair<double, int> key = {cand.cost, cand.pair_id};
+      auto pos = std::lower_bound(order.begin(), order.begin() + k, key);
+      std::move_backward(pos, order.begin() + k, order.begin() + k + 1);
+      *pos = key;
     }
   }
+}
+
+/**
+ * @brief Checks that a recorded path exists in the graph and joins its pair.
+ * * The edges are checked as a set, the order they were recorded in does not
+ * matter.
+ */
+static bool joinsPair(const Graph& graph, const int source, const int target,
+                      const int* begin, const int* end, SparseDSU& dsu) {
+  dsu.reset();
+  for (const int* e = begin; e != end; ++e) {
+    if (*e == -1) return false;
+    dsu.unite(graph.edges[*e].source, graph.edges[*e].target);
+  }
+  return dsu.isConnected(source, target);
+}
 
+SFPSolution WarmStartHeuristic::generate(const SFPProblem* problem) {
+  SFPSolution solution = problem->empty_solution();
+  generateInto(problem, solution);
   return solution;
 }
+
+void WarmStartHeuristic::generateInto(const SFPProblem* problem, SFPSolution& solution) {
+  SFP_STAT_TIMER(CONSTRUCTIVE);
+  if (!dijkstra)
+    dijkstra = BidirectionalDijkstraEngine::create(problem->getGraphPtr(), nullptr, queue);
+
+  const Graph& graph = *problem->getGraphPtr();
+  const int nNodes = problem->getNNodes();
+  const auto& terminals = problem->getTerminals();
+
+  // Terminal groups of the current problem
+  SparseDSU groups(nNodes);
+  std::vector<bool> isTerminal(nNodes, false);
+  for (const auto& [s, t] : terminals) {
+    groups.unite(s, t);
+    isTerminal[s] = isTerminal[t] = true;
+  }
+
+  // Snapshot pairs still inside a group, without closing cycles
+  SparseDSU forest(nNodes);
+  std::vector<SolutionPair> pairs;
+  std::vector<int> recorded;  ///< Snapshot pair of each kept pair
+  for (int p = 0; p < static_cast<int>(snapshot->pairs.size()); ++p) {
+    auto [s, t] = snapshot->pairs[p];
+    if (s >= nNodes || t >= nNodes || !isTerminal[s] || !isTerminal[t]) continue;
+    if (!groups.isConnected(s, t) || !forest.unite(s, t)) continue;
+    pairs.emplace_back(s, t);
+    recorded.push_back(p);
+  }
+
+  // New pairs for what the snapshot leaves disconnected
+  for (const auto& [s, t] : terminals)
+    if (forest.unite(s, t)) pairs.emplace_back(s, t);
+
+  if (solution.getProblem() != problem) solution = problem->empty_solution();
+  solution.reinit(pairs);
+
+  keptPaths = 0;
+  std::vector<int> repairs;
+  SparseDSU pathSets(nNodes);
+  for (int p = 0; p < static_cast<int>(pairs.size()); ++p) {
+    if (p < static_cast<int>(recorded.size())) {
+      const int* begin = snapshot->pathEdges.data() + snapshot->pathOffsets[recorded[p]];
+      const int* end = snapshot->pathEdges.data() + snapshot->pathOffsets[recorded[p] + 1];
+      if (joinsPair(graph, pairs[p].source, pairs[p].target, begin, end, pathSets)) {
+        for (const int* e = begin; e != end; ++e) solution.insert(*e, p);
+        keptPaths++;
+        continue;
+      }
+    }
+    repairs.push_back(p);
+  }
+
+  // Reroute over the reinstalled forest, its edges are free to reuse
+  for (int p : repairs) {
+    auto path = dijkstra->getShortPath(pairs[p].source, pairs[p].target,
+                                       solution.getNEdges() ? solution.getBitmask() : nullptr);
+    if (path.second < 0)
+      throw std::runtime_error("\tWarm start: terminals " + std::to_string(pairs[p].source + 1) + " and " +
+                               std::to_string(pairs[p].target + 1) + " cannot be reconnected.");
+    SFPMove move(&solution, MoveType::CNCT_PAIR, p, std::move(path.first));
+    move.apply();
+  }
+  repairedPaths = repairs.size();
+}
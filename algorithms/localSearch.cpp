@@ -1,206 +1,323 @@
 #include <algorithm>
+#include <functional>
 #include <utility>
 #include <vector>
 
 #include "Solver.hpp"
 
-bool GRASPLocalSearch::optimize(SFPSolution* solution) {
-  if (!dijkstra)
-    dijkstra = std::make_shared<BidirectionalDijkstraEngine>(
-        solution->getProblem()->getGraphPtr());
+namespace {
+
+/**
+ * @struct RerouteScratch
+ * @brief Private copy of the solution edge state where reroutes are tried.
+ */
+struct RerouteScratch {
+  EdgeMask state;                                 ///< Copy of the solution edge state
+  std::vector<int> released;                     ///< Edges freed by the destroy step
+  std::vector<std::pair<int, uint8_t>> undoLog;  ///< {edge, previous state}
+  long long version = -1;                        ///< Solution version of the copy
+
+  void sync(const SFPSolution& solution, const long long current) {
+    if (version == current) return;
+    state = *solution.getBitmask();
+    version = current;
+  }
+};
+
+/**
+ * @brief Outcome of a reroute tried on a scratch state.
+ */
+struct RerouteTrial {
+  bool improving = false;
+  std::vector<int> pairs;               ///< Rerouted pairs, in repair order
+  std::vector<std::vector<int>> paths;  ///< New path of each rerouted pair
+};
+
+/**
+ * @brief Bounded repair search: only paths cheaper than `budget` can improve
+ * the move, and the hop limit of each frontier starts around half the old
+ * path length and doubles (up to unbounded) while the search fails. A
+ * cap of `nNodes` hops or more cannot bind, so widening stops there.
+ */
+std::pair<std::vector<int>, float> boundedRepair(BidirectionalDijkstraEngine& engine,
+                                                 const int source, const int target,
+                                                 const EdgeMask& state, const int nNodes,
+                                                 const int oldLength, const float budget) {
+  for (int hops = oldLength / 2 + 2; hops < nNodes; hops *= 2) {
+    auto path = engine.getShortPath(source, target, &state, hops, budget);
+    // Without hop pruning the failure is due to the budget, widening is useless
+    if (path.second >= 0 || !engine.hopLimitReached()) return path;
+  }
+  return engine.getShortPath(source, target, &state, -1, budget);
+}
 
-  int nEdges = solution->getProblem()->getNEdges();
-  std::vector<uint8_t> ditchs(nEdges, 0);
+/**
+ * @brief Disconnects trial.pairs, forbids the ditches and reconnects the
+ * pairs one by one on the scratch state, each new path becoming bridges for
+ * the next ones. The move is priced by SFPSolution::evaluateReroute and the
+ * scratch state is restored before returning; the solution is only read.
+ * * With `bounded`, repairs run under the cost left by the freed edges (see
+ * boundedRepair) and the trial stops at the first one that does not fit.
+ */
+void tryReroute(const SFPSolution& solution, BidirectionalDijkstraEngine& engine,
+                const std::vector<int>& ditches, RerouteScratch& scratch, RerouteTrial& trial,
+                const bool bounded = false) {
+  const Graph& graph = *solution.getProblem()->getGraphPtr();
+  auto& state = scratch.state;
+  auto set = [&](const int e, const uint8_t value) {
+    scratch.undoLog.push_back({e, state.get(e)});
+    state.set(e, value);
+    if (graph.rev[e] != -1) {
+      scratch.undoLog.push_back({graph.rev[e], state.get(graph.rev[e])});
+      state.set(graph.rev[e], value);
+    }
+  };
 
-  const std::vector<SolutionEdge>* edgesToTest = solution->getEdges();
+  trial.improving = false;
+  trial.paths.clear();
 
-  std::vector<int> affectedPairs;
-  affectedPairs.reserve(solution->getNPairs());
-  SFPNeighborhood destroy;
-  destroy.moves.reserve(solution->getNPairs());
-  SFPNeighborhood repair;
-  repair.moves.reserve(solution->getNPairs());
+  // Cost the new paths may add before the move stops improving
+  double budget = -1e-4;
+  solution.releasedEdges(trial.pairs, scratch.released);
+  for (int e : scratch.released) {
+    set(e, state.get(e) & ~EDGE_BRIDGE);
+    budget += graph.weights[e];
+  }
+  for (int e : ditches) set(e, state.get(e) | EDGE_DITCH);
+
+  bool feasible = true;
+  for (int pair : trial.pairs) {
+    auto [source, target] = solution.getPairNodes(pair);
+    auto path = !bounded ? engine.getShortPath(source, target, &state)
+                : budget > 0.0 ? boundedRepair(engine, source, target, state, graph.nNodes,
+                                               solution.getPairEdges(pair)->size(), budget)
+                               : std::make_pair(std::vector<int>(), -1.0f);
+    if (path.second < 0) {
+      feasible = false;
+      break;
+    }
+    budget -= path.second;
+    for (int e : path.first)
+      if (!state.isBridge(e)) set(e, state.get(e) | EDGE_BRIDGE);
+    trial.paths.push_back(std::move(path.first));
+  }
 
-  double currentBestCost = solution->getCurrentCost();
-  bool foundAnyImprovement = false;
+  for (auto it = scratch.undoLog.rbegin(); it != scratch.undoLog.rend(); ++it)
+    state.set(it->first, it->second);
+  scratch.undoLog.clear();
 
-  for (const auto& edgeToDrop : *edgesToTest) {
-    if (!solution->isEdgeActive(edgeToDrop.id)) continue;
+  trial.improving = feasible && solution.evaluateReroute(trial.pairs, trial.paths) < -1e-4;
+}
 
-    ditchs[edgeToDrop.id] = 1;
-    if (edgeToDrop.reverse_id != -1) ditchs[edgeToDrop.reverse_id] = 1;
+/**
+ * @brief Applies an accepted reroute: destroy the old paths, then insert the
+ * ones found by the trial.
+ */
+void applyReroute(SFPSolution* solution, RerouteTrial& trial) {
+  SFPNeighborhood destroy;
+  for (int pair_id : trial.pairs)
+    destroy.moves.push_back({solution, MoveType::DSCNCT_PAIR, pair_id, *solution->getPairEdges(pair_id)});
+  destroy.apply();
+  SFPNeighborhood repair;
+  for (size_t p = 0; p < trial.pairs.size(); ++p)
+    repair.addMoveApplying({solution, MoveType::CNCT_PAIR, trial.pairs[p], std::move(trial.paths[p])});
+}
 
-    affectedPairs.clear();
-    destroy.moves.clear();
-    repair.moves.clear();
+}  // namespace
+
+/**
+ * @struct GRASPLocalSearch::DropScratch
+ * @brief Private state of one evaluation worker.
+ */
+struct GRASPLocalSearch::DropScratch {
+  std::shared_ptr<BidirectionalDijkstraEngine> engine;
+  RerouteScratch reroute;
+  std::vector<int> ditch;  ///< The dropped edge
+};
+
+GRASPLocalSearch::GRASPLocalSearch(std::shared_ptr<BidirectionalDijkstraEngine> externalDijkstra,
+                                   const int nThreads, const QueueKind queue,
+                                   const bool bounded)
+    : dijkstra(externalDijkstra), nThreads(std::max(1, nThreads)), queue(queue), bounded(bounded),
+      stateVersion(0) {
+  if (this->nThreads > 1) pool = std::make_unique<ThreadPool>(this->nThreads);
+}
+
+GRASPLocalSearch::~GRASPLocalSearch() = default;
 
-    for (int pair_id : *solution->getEdgePairs(edgeToDrop.id)){
-      affectedPairs.push_back(pair_id);
-      destroy.moves.push_back({solution, MoveType::DSCNCT_PAIR, pair_id, *solution->getPairEdges(pair_id)});
+bool GRASPLocalSearch::optimize(SFPSolution* solution, const std::function<bool()>& shouldStop) {
+  SFP_STAT_TIMER(GRASP_LS);
+  if (!dijkstra)
+    dijkstra = BidirectionalDijkstraEngine::create(
+        solution->getProblem()->getGraphPtr(), nullptr, queue);
+  const auto graph = solution->getProblem()->getGraphPtr();
+
+  if (scratch.empty())
+    for (int w = 0; w < nThreads; ++w) {
+      auto worker = std::make_unique<DropScratch>();
+      worker->engine = w == 0 ? dijkstra : BidirectionalDijkstraEngine::create(graph, nullptr, queue);
+      worker->ditch.assign(1, -1);
+      scratch.push_back(std::move(worker));
     }
 
-    destroy.apply();
-    bool feasible = true;
+  // Edges active at the start of the pass, in order
+  std::vector<int> candidates;
+  candidates.reserve(solution->getNEdges());
+  for (const auto& edge : *solution->getEdges()) candidates.push_back(edge.id);
 
-    for (auto pair : affectedPairs) {
-      auto [source, target] = solution->getPairNodes(pair);
+  // Worker copies of the edge state are refreshed whenever the solution changes
+  stateVersion++;
 
-      auto result = dijkstra->getShortPath(source, target, solution->getBitmask(), &ditchs);
+  // A few drops per worker: an accepted move discards the rest of its batch
+  const int batchSize = pool ? nThreads * 4 : 1;
+  std::vector<RerouteTrial> results(batchSize);
+  bool foundAnyImprovement = false;
 
-      if (result.second < 0) {
-        feasible = false;
-        break;
-      }
+  auto evaluate = [&](const size_t first, const int i, const int w) {
+    DropScratch& local = *scratch[w];
+    RerouteTrial& trial = results[i];
+    const int dropId = candidates[first + i];
+    trial.improving = false;
+    if (!solution->isEdgeActive(dropId)) return;
+
+    local.reroute.sync(*solution, stateVersion);
+    local.ditch[0] = dropId;
+    trial.pairs = *solution->getEdgePairs(dropId);
+    SFP_STAT_INC(GRASP_LS_TRIED);
+    tryReroute(*solution, *local.engine, local.ditch, local.reroute, trial, bounded);
+  };
 
-      repair.addMoveApplying({solution, MoveType::CNCT_PAIR, pair, std::move(result.first)});
-    }
+  size_t k = 0;
+  while (k < candidates.size()) {
+    if (shouldStop && shouldStop()) break;
+    const int count = std::min<size_t>(batchSize, candidates.size() - k);
 
-    double newCost = solution->getCurrentCost();
+    if (pool) pool->parallelFor(count, [&](const int i, const int w) { evaluate(k, i, w); });
+    else evaluate(k, 0, 0);
 
-    if (feasible && newCost < currentBestCost - 1e-4) {
-      currentBestCost = newCost;
-      foundAnyImprovement = true;
-    } else {
-      repair.undo();
-      destroy.undo();
+    int first = 0;
+    while (first < count && !results[first].improving) first++;
+    if (first == count) {
+      k += count;
+      continue;
     }
 
-    ditchs[edgeToDrop.id] = 0;
-    if (edgeToDrop.reverse_id != -1) ditchs[edgeToDrop.reverse_id] = 0;
+    applyReroute(solution, results[first]);
+    SFP_STAT_INC(GRASP_LS_ACCEPTED);
+    stateVersion++;
+    foundAnyImprovement = true;
+    k += first + 1;
   }
   return foundAnyImprovement;
 }
 
 
-bool HubBreakingLocalSearch::optimize(SFPSolution* solution) {
-  if (!dijkstra)
-    dijkstra = std::make_shared<BidirectionalDijkstraEngine>(
-        solution->getProblem()->getGraphPtr());
-
-  const auto* problem = solution->getProblem();
-  const auto graph = problem->getGraphPtr();
-  int nNodes = problem->getNNodes();
-  int nEdges = problem->getNEdges();
+/**
+ * @struct HubBreakingLocalSearch::HubScratch
+ * @brief Buffers of a pass, kept for the next ones.
+ */
+struct HubBreakingLocalSearch::HubScratch {
+  RerouteScratch reroute;
+  std::vector<std::pair<double, int>> heap;  ///< {instability, hub}
+  std::vector<int> dropped;                  ///< Active edges of the hub being tried
+  std::vector<unsigned int> pairSeen;        ///< Pair stamps, deduplicate without sorting
+  unsigned int token = 0;
+  long long version = 0;
+
+  /// Active edges of a node from its CSR row, lower id of each twin
+  void collectEdges(const SFPSolution& solution, const Graph& graph, const int node) {
+    dropped.clear();
+    for (int e = graph.ptrs[node]; e < graph.ptrs[node + 1]; ++e)
+      if (solution.isEdgeActive(e)) dropped.push_back(std::min(e, graph.rev[e]));
+  }
 
-  struct HubInfo {
-    int nodeId;
-    std::vector<int> activeEdges;
-    double totalCost = 0.0;
-    double instabilityIndex = 0.0;
-  };
+  /// Distinct pairs using the collected edges, in first-seen order
+  void collectPairs(const SFPSolution& solution, std::vector<int>& pairs) {
+    if (pairSeen.size() < static_cast<size_t>(solution.getNPairs())) pairSeen.resize(solution.getNPairs(), 0);
+    if (++token == 0) {
+      std::fill(pairSeen.begin(), pairSeen.end(), 0);
+      token = 1;
+    }
+    pairs.clear();
+    for (int edgeId : dropped)
+      for (int p : *solution.getEdgePairs(edgeId))
+        if (pairSeen[p] != token) {
+          pairSeen[p] = token;
+          pairs.push_back(p);
+        }
+  }
+};
 
-  std::vector<HubInfo> hubs(nNodes);
-  for (int i = 0; i < nNodes; ++i) hubs[i].nodeId = i;
+HubBreakingLocalSearch::HubBreakingLocalSearch(std::shared_ptr<BidirectionalDijkstraEngine> externalDijkstra,
+                                               const bool bounded, const int topK,
+                                               const bool firstImprovement)
+    : dijkstra(externalDijkstra), bounded(bounded), topK(topK), firstImprovement(firstImprovement),
+      scratch(std::make_unique<HubScratch>()) {}
 
-  const auto* active_edges = solution->getEdges();
-  for (const auto& sEdge : *active_edges) { 
-    int u = graph->edges[sEdge.id].source;
-    int v = graph->edges[sEdge.id].target;
-    double weight = sEdge.weight; 
+HubBreakingLocalSearch::~HubBreakingLocalSearch() = default;
 
-    hubs[u].activeEdges.push_back(sEdge.id);
-    hubs[u].totalCost += weight;
+bool HubBreakingLocalSearch::optimize(SFPSolution* solution, const std::function<bool()>& shouldStop) {
+  SFP_STAT_TIMER(HUB_LS);
+  if (!dijkstra)
+    dijkstra = BidirectionalDijkstraEngine::create(
+        solution->getProblem()->getGraphPtr());
 
-    hubs[v].activeEdges.push_back(sEdge.id);
-    hubs[v].totalCost += weight;
+  const Graph& graph = *solution->getProblem()->getGraphPtr();
+  HubScratch& local = *scratch;
+  RerouteTrial trial;
+  std::vector<int>& pairs = trial.pairs;
+
+  // Instability of the hubs at the start of the pass
+  auto& heap = local.heap;
+  heap.clear();
+  for (int hub : *solution->getHubs()) {
+    local.collectEdges(*solution, graph, hub);
+    local.collectPairs(*solution, pairs);
+    if (pairs.empty()) continue;
+
+    double totalCost = 0.0, sumSynergy = 0.0;
+    for (int edgeId : local.dropped) totalCost += graph.weights[edgeId];
+    for (int p : pairs) sumSynergy += 1.0 + solution->getPair(p).synergy;
+    heap.push_back({totalCost / (sumSynergy / pairs.size()), hub});
   }
 
-  std::vector<HubInfo> hubsToTest;
-  hubsToTest.reserve(nNodes);
-
-  for (auto& hub : hubs) {
-    if ((int) hub.activeEdges.size() < 3) continue;
- 
-    std::vector<int> affectedPairs; 
-    for (int edgeId : hub.activeEdges) { 
-      const auto* pList = solution->getEdgePairs(edgeId); 
-      affectedPairs.insert(affectedPairs.end(), pList->begin(), pList->end());
-    }
-    
-    std::sort(affectedPairs.begin(), affectedPairs.end());
-    affectedPairs.erase(std::unique(affectedPairs.begin(), affectedPairs.end()), affectedPairs.end());
-
-    if (affectedPairs.empty()) continue;
- 
-    double sumSynergy = 0.0; 
-    for (int pId : affectedPairs) 
-      sumSynergy += (1.0 + solution->getPair(pId).synergy); 
-    
-    double averageSynergy = sumSynergy / affectedPairs.size();
-
-    hub.instabilityIndex = hub.totalCost / averageSynergy;
-    hubsToTest.push_back(hub);
-  }
+  // Most unstable first, ties to the lowest node
+  auto lower = [](const std::pair<double, int>& a, const std::pair<double, int>& b) {
+    return a.first != b.first ? a.first < b.first : a.second > b.second;
+  };
+  std::make_heap(heap.begin(), heap.end(), lower);
 
-  std::sort(hubsToTest.begin(), hubsToTest.end(),
-            [](const HubInfo& a, const HubInfo& b) {
-              return a.instabilityIndex > b.instabilityIndex;
-            }); 
- 
-  std::vector<uint8_t> ditchs(nEdges, 0); 
-  double currentBestCost = solution->getCurrentCost(); 
   bool foundAnyImprovement = false;
-
-  for (const auto& hub : hubsToTest) {
- 
-    std::vector<int> validEdgesToDrop; 
-    for (int edgeId : hub.activeEdges) 
-      if (solution->isEdgeActive(edgeId)) validEdgesToDrop.push_back(edgeId);
-
-    if ((int) validEdgesToDrop.size() < 3) continue;
- 
-    std::vector<int> pairsToRepair; 
-    for (int edgeId : validEdgesToDrop) { 
-      const auto* pList = solution->getEdgePairs(edgeId); 
-      pairsToRepair.insert(pairsToRepair.end(), pList->begin(), pList->end());
-    }
-    std::sort(pairsToRepair.begin(), pairsToRepair.end());
-    pairsToRepair.erase(std::unique(pairsToRepair.begin(), pairsToRepair.end()), pairsToRepair.end());
-
-    std::sort(pairsToRepair.begin(), pairsToRepair.end(), [&](int a, int b) {
-      return solution->getPair(a).synergy > solution->getPair(b).synergy; 
+  int tried = 0;
+  // Every pass starts from a fresh copy of the edge state
+  local.version++;
+  while (!heap.empty() && (topK <= 0 || tried < topK)) {
+    if (shouldStop && shouldStop()) break;
+    std::pop_heap(heap.begin(), heap.end(), lower);
+    const int hub = heap.back().second;
+    heap.pop_back();
+
+    // Earlier moves may have broken it already
+    if (solution->getActiveDegree(hub) < 3) continue;
+    local.collectEdges(*solution, graph, hub);
+    local.collectPairs(*solution, pairs);
+    std::sort(pairs.begin(), pairs.end(), [&](int a, int b) {
+      int synergyA = solution->getPair(a).synergy, synergyB = solution->getPair(b).synergy;
+      return synergyA != synergyB ? synergyA > synergyB : a < b;
     });
 
-    for (int id : validEdgesToDrop) {
-      ditchs[id] = 1;
-      int rev = graph->edges[id].reverseEdgePtr;
-      if (rev != -1) ditchs[rev] = 1;
-    }  
-  
-    SFPNeighborhood destroy; 
-    SFPNeighborhood repair;
-
-    for (int pId : pairsToRepair) {  
-      std::vector<int> currentPath = *solution->getPairEdges(pId);  
-      destroy.addMoveApplying({solution, MoveType::DSCNCT_PAIR, pId, currentPath}); 
-    }
- 
-    bool feasible = true; 
-    for (int pId : pairsToRepair) {
-      auto [src, tgt] = solution->getPairNodes(pId);  
-       
-      auto res = dijkstra->getShortPath(src, tgt, solution->getBitmask(), &ditchs); 
-
-      if (res.second < 0) {
-        feasible = false; 
-        break; 
-      } 
-      repair.addMoveApplying({solution, MoveType::CNCT_PAIR, pId, std::move(res.first)});
-    } 
- 
-    if (feasible && solution->getCurrentCost() < currentBestCost - 1e-4) {
-      currentBestCost = solution->getCurrentCost();
-      foundAnyImprovement = true;
-    } 
-    else {  
-      repair.undo();  
-      destroy.undo(); 
-    }
+    // Only the accepted moves touch the solution
+    local.reroute.sync(*solution, local.version);
+    SFP_STAT_INC(HUB_LS_TRIED);
+    tried++;
+    tryReroute(*solution, *dijkstra, local.dropped, local.reroute, trial, bounded);
 
-    for (int id : validEdgesToDrop) {
-      ditchs[id] = 0;
-      int rev = graph->edges[id].reverseEdgePtr;
-      if (rev != -1) ditchs[rev] = 0;
+    if (trial.improving) {
+      applyReroute(solution, trial);
+      SFP_STAT_INC(HUB_LS_ACCEPTED);
+      local.version++;
+      foundAnyImprovement = true;
+      if (firstImprovement) break;
     }
   }
 
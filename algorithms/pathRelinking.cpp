@@ -0,0 +1,163 @@
+#include <algorithm>
+#include <climits>
+#include <utility>
+#include <vector>
+
+#include "Solver.hpp"
+
+namespace {
+
+/// Active edges of a solution, lower id of each twin, sorted
+std::vector<int> edgeSet(const SFPSolution& solution) {
+  std::vector<int> edges;
+  edges.reserve(solution.getNEdges());
+  for (const auto& edge : *solution.getEdges()) edges.push_back(edge.id);
+  std::sort(edges.begin(), edges.end());
+  return edges;
+}
+
+/// Path edges as a sorted set of lower twin ids, whatever their direction
+void canonicalPath(const Graph& graph, const std::vector<int>& path, std::vector<int>& out) {
+  out.clear();
+  for (int e : path) out.push_back(graph.rev[e] != -1 ? std::min(e, graph.rev[e]) : e);
+  std::sort(out.begin(), out.end());
+}
+
+}  // namespace
+
+int EliteSet::distance(const std::vector<int>& a, const std::vector<int>& b) {
+  int common = 0;
+  for (size_t i = 0, j = 0; i < a.size() && j < b.size();) {
+    if (a[i] == b[j]) {
+      common++;
+      i++;
+      j++;
+    } else if (a[i] < b[j]) {
+      i++;
+    } else {
+      j++;
+    }
+  }
+  return a.size() + b.size() - 2 * common;
+}
+
+bool EliteSet::offer(const SFPSolution& solution) {
+  std::vector<int> edges = edgeSet(solution);
+  const double cost = solution.getCurrentCost();
+
+  std::lock_guard<std::mutex> lock(mutex);
+  int slot = -1;
+  for (int m = 0; m < static_cast<int>(members.size()); ++m)
+    if (members[m].edges == edges) {
+      if (cost >= members[m].snapshot.cost) return false;
+      slot = m;
+      break;
+    }
+
+  if (slot == -1 && static_cast<int>(members.size()) < capacity) {
+    members.emplace_back();
+    slot = members.size() - 1;
+  } else if (slot == -1) {
+    if (cost >= members.back().snapshot.cost) return false;
+    // The closest member no cheaper than the candidate leaves
+    int closest = INT_MAX;
+    for (int m = 0; m < static_cast<int>(members.size()); ++m) {
+      if (members[m].snapshot.cost < cost) continue;
+      int d = distance(members[m].edges, edges);
+      if (d < closest) {
+        closest = d;
+        slot = m;
+      }
+    }
+  }
+
+  members[slot].snapshot.capture(solution);
+  members[slot].edges = std::move(edges);
+  std::stable_sort(members.begin(), members.end(), [](const Member& a, const Member& b) {
+    return a.snapshot.cost < b.snapshot.cost;
+  });
+  return true;
+}
+
+bool EliteSet::pickGuide(const SFPSolution& solution, std::mt19937& rng, SFPSnapshot& guide) const {
+  const std::vector<int> edges = edgeSet(solution);
+
+  std::lock_guard<std::mutex> lock(mutex);
+  std::vector<int> candidates;
+  for (int m = 0; m < static_cast<int>(members.size()); ++m)
+    if (members[m].edges != edges) candidates.push_back(m);
+  if (candidates.empty()) return false;
+
+  std::uniform_int_distribution<int> pick(0, candidates.size() - 1);
+  guide = members[candidates[pick(rng)]].snapshot;
+  return true;
+}
+
+int EliteSet::size() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return members.size();
+}
+
+double EliteSet::bestCost() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return members.empty() ? std::numeric_limits<double>::infinity() : members.front().snapshot.cost;
+}
+
+int PathRelinking::relink(SFPSolution& solution, const SFPSnapshot& guide) {
+  const SFPProblem* problem = solution.getProblem();
+  const Graph& graph = *problem->getGraphPtr();
+  if (!dijkstra) dijkstra = BidirectionalDijkstraEngine::create(problem->getGraphPtr(), nullptr, queue);
+
+  guideState.assign(graph.nEdges, EDGE_DITCH);
+  for (int e : guide.edges) guideState.set(e, graph.rev[e], EDGE_FREE);
+
+  // The guide joins every terminal group, hence every pair of the solution
+  const int nPairs = solution.getNPairs();
+  std::vector<std::vector<int>> guidePaths(nPairs);
+  std::vector<int> pending, current, target;
+  for (int p = 0; p < nPairs; ++p) {
+    auto [source, sink] = solution.getPairNodes(p);
+    auto path = dijkstra->getShortPath(source, sink, &guideState);
+    if (path.second < 0) continue;
+    canonicalPath(graph, *solution.getPairEdges(p), current);
+    canonicalPath(graph, path.first, target);
+    if (current == target) continue;
+    guidePaths[p] = std::move(path.first);
+    pending.push_back(p);
+  }
+
+  int steps = 0, bestStep = 0;
+  double bestCost = std::numeric_limits<double>::infinity();
+  std::vector<int> move(1);
+  std::vector<std::vector<int>> movePath(1);
+  while (!pending.empty()) {
+    // Cheapest pair to switch to its guide path, ties to the lowest id
+    int choice = 0;
+    double choiceDelta = std::numeric_limits<double>::infinity();
+    for (int k = 0; k < static_cast<int>(pending.size()); ++k) {
+      move[0] = pending[k];
+      std::swap(movePath[0], guidePaths[pending[k]]);
+      double delta = solution.evaluateReroute(move, movePath);
+      std::swap(movePath[0], guidePaths[pending[k]]);
+      if (delta < choiceDelta) {
+        choiceDelta = delta;
+        choice = k;
+      }
+    }
+
+    const int p = pending[choice];
+    SFPMove(&solution, MoveType::DSCNCT_PAIR, p, *solution.getPairEdges(p)).apply();
+    SFPMove(&solution, MoveType::CNCT_PAIR, p, std::move(guidePaths[p])).apply();
+    pending.erase(pending.begin() + choice);
+    steps++;
+
+    if (solution.getCurrentCost() < bestCost) {
+      bestCost = solution.getCurrentCost();
+      bestStep = steps;
+      if (!pending.empty()) best.capture(solution);
+    }
+  }
+
+  if (bestStep != steps) best.restore(solution);
+  return steps;
+}
@@ -0,0 +1,187 @@
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+#include "Service.hpp"
+
+SolverService::SolverService(const int nThreads) {
+  for (int t = 0; t < std::max(1, nThreads); ++t) threads.emplace_back(&SolverService::workerLoop, this);
+}
+
+SolverService::~SolverService() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+    for (auto& job : queue) job->cancel();
+    for (auto& job : running) job->cancel();
+    queue.clear();
+  }
+  wake.notify_all();
+  for (auto& thread : threads) thread.join();
+}
+
+SolverService::Handle SolverService::submit(std::shared_ptr<const SFPProblem> problem,
+                                            const std::string& algorithm, SolverConfig config) {
+  if (algorithm != "GRASP" && algorithm != "HUB")
+    throw std::runtime_error("\tUnknown algorithm: " + algorithm);
+  if (!problem) throw std::runtime_error("\tNo problem to solve.");
+
+  auto job = std::make_shared<Job>();
+  job->problem = std::move(problem);
+  job->algorithm = algorithm;
+  job->config = std::move(config);
+
+  // The service cancellation comes first, the caller's own rule still applies
+  Job* raw = job.get();
+  job->config.shouldStop = [raw, user = std::move(job->config.shouldStop)] {
+    return raw->cancelled.load(std::memory_order_relaxed) || (user && user());
+  };
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (stopping) throw std::runtime_error("\tThe solver service is stopped.");
+    queue.push_back(job);
+  }
+  wake.notify_one();
+  return Handle(std::move(job));
+}
+
+void SolverService::workerLoop() {
+  while (true) {
+    std::shared_ptr<Job> job;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      wake.wait(lock, [&] { return stopping || !queue.empty(); });
+      if (queue.empty()) return;
+      job = std::move(queue.front());
+      queue.pop_front();
+      running.push_back(job);
+    }
+
+    execute(*job);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    running.erase(std::find(running.begin(), running.end(), job));
+  }
+}
+
+void SolverService::execute(Job& job) {
+  {
+    std::lock_guard<std::mutex> lock(job.mutex);
+    if (job.result.status == JobStatus::CANCELLED) return;  // Dropped while queued
+    job.result.status = JobStatus::RUNNING;
+  }
+
+  ServiceResult result;
+  std::shared_ptr<SolverResources> resources;
+  try {
+    resources = acquire(job);
+    auto start = std::chrono::steady_clock::now();
+    std::unique_ptr<SolverStrategy> solver;
+    if (job.algorithm == "GRASP")
+      solver = std::make_unique<Metaheuristics<GRASPLocalSearch>>(job.problem.get(), job.config, resources);
+    else
+      solver = std::make_unique<Metaheuristics<HubBreakingLocalSearch>>(job.problem.get(), job.config, resources);
+    result.solution = solver->solve();
+    result.firstCost = solver->getFirstCost();
+    result.timeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    result.status = job.cancelled ? JobStatus::CANCELLED : JobStatus::DONE;
+  } catch (const std::exception& e) {
+    result.solution.reset();
+    result.status = JobStatus::FAILED;
+    result.error = e.what();
+  }
+  // Engines of a failed run may be mid-search, they are not reused
+  if (resources && result.status != JobStatus::FAILED) release(job, std::move(resources));
+
+  {
+    std::lock_guard<std::mutex> lock(job.mutex);
+    job.result = std::move(result);
+  }
+  job.finished.notify_all();
+}
+
+std::shared_ptr<SolverResources> SolverService::acquire(const Job& job) {
+  std::lock_guard<std::mutex> lock(mutex);
+  Session& session = sessions[{job.problem.get(), job.config.queue, job.config.nLandmarks}];
+  // Same address, other problem: the old one is gone
+  if (session.problem.lock() != job.problem) session = Session{job.problem, nullptr, nullptr, {}};
+
+  if (!session.idle.empty()) {
+    auto resources = std::move(session.idle.back());
+    session.idle.pop_back();
+    return resources;
+  }
+  auto resources = std::make_shared<SolverResources>();
+  resources->landmarks = session.landmarks;
+  resources->pathCache = session.pathCache;
+  return resources;
+}
+
+void SolverService::release(const Job& job, std::shared_ptr<SolverResources> resources) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto it = sessions.find({job.problem.get(), job.config.queue, job.config.nLandmarks});
+  if (it == sessions.end() || it->second.problem.lock() != job.problem) return;  // Forgotten meanwhile
+
+  Session& session = it->second;
+  if (!session.landmarks) session.landmarks = resources->landmarks;
+  if (!session.pathCache) session.pathCache = resources->pathCache;
+  session.idle.push_back(std::move(resources));
+}
+
+void SolverService::forget(const SFPProblem* problem) {
+  std::lock_guard<std::mutex> lock(mutex);
+  for (auto it = sessions.begin(); it != sessions.end();)
+    it = std::get<0>(it->first) == problem ? sessions.erase(it) : std::next(it);
+}
+
+int SolverService::warmInstances() {
+  std::lock_guard<std::mutex> lock(mutex);
+  std::vector<const SFPProblem*> problems;
+  for (const auto& [key, session] : sessions)
+    if (!session.idle.empty()) problems.push_back(std::get<0>(key));
+  problems.erase(std::unique(problems.begin(), problems.end()), problems.end());
+  return problems.size();
+}
+
+void SolverService::Job::cancel() {
+  cancelled = true;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (result.status != JobStatus::QUEUED) return;  // A running job stops on the flag
+    result.status = JobStatus::CANCELLED;
+  }
+  finished.notify_all();
+}
+
+SolverService::Job& SolverService::Handle::get() const {
+  if (!job) throw std::runtime_error("\tEmpty solver service handle.");
+  return *job;
+}
+
+JobStatus SolverService::Handle::status() const {
+  Job& target = get();
+  std::lock_guard<std::mutex> lock(target.mutex);
+  return target.result.status;
+}
+
+void SolverService::Handle::cancel() { get().cancel(); }
+
+bool SolverService::Handle::waitFor(const double timeoutMs) const {
+  Job& target = get();
+  std::unique_lock<std::mutex> lock(target.mutex);
+  auto done = [&] {
+    JobStatus status = target.result.status;
+    return status != JobStatus::QUEUED && status != JobStatus::RUNNING;
+  };
+  return target.finished.wait_for(lock, std::chrono::duration<double, std::milli>(timeoutMs), done);
+}
+
+const ServiceResult& SolverService::Handle::result() const {
+  Job& target = get();
+  std::unique_lock<std::mutex> lock(target.mutex);
+  target.finished.wait(lock, [&] {
+    return target.result.status != JobStatus::QUEUED && target.result.status != JobStatus::RUNNING;
+  });
+  return target.result;
+}
@@ -0,0 +1,144 @@
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * @file Benchmark.hpp
+ * @brief Minimal timing harness of the steiner_forest_bench target.
+ * * A case is a body callable run repeatedly until a time budget is spent,
+ * with an optional untimed setup before every iteration (e.g. copying the
+ * solution a local search pass consumes). Results are written as JSON or
+ * CSV so runs of different versions can be diffed by scripts.
+ */
+
+/**
+ * @struct BenchmarkResult
+ * @brief Statistics of one case, times in nanoseconds per iteration.
+ */
+struct BenchmarkResult {
+  std::string name;      ///< Case name, "<group>/<variant>"
+  std::string instance;  ///< Instance file name
+  long long iterations = 0;
+  double meanNs = 0.0;
+  double medianNs = 0.0;
+  double minNs = 0.0;
+  double maxNs = 0.0;
+  double stddevNs = 0.0;
+  double itemsPerSecond = 0.0;  ///< Work units (queries, edges...) per second
+  double value = 0.0;           ///< Case checksum / quality (e.g. solution cost)
+};
+
+/**
+ * @class BenchmarkRunner
+ * @brief Runs the cases and collects their results.
+ */
+class BenchmarkRunner {
+ private:
+  double minTimeSec;
+  long long minIterations;
+  std::string filter;
+  std::vector<BenchmarkResult> results;
+
+  using Clock = std::chrono::steady_clock;
+
+ public:
+  /**
+   * @param minTimeSec Time budget of each case (timed part only).
+   * @param minIterations Iterations run even when the budget is exhausted.
+   * @param filter Only cases whose name contains it are run (empty = all).
+   */
+  BenchmarkRunner(const double minTimeSec, const long long minIterations,
+                  std::string filter = "")
+      : minTimeSec(minTimeSec), minIterations(minIterations), filter(std::move(filter)) {}
+
+  bool enabled(const std::string& name) const {
+    return filter.empty() || name.find(filter) != std::string::npos;
+  }
+
+  /**
+   * @brief Times `body` after an untimed `setup` on every iteration.
+   * @param items Work units done by one body call, for the throughput.
+   * @param body Returns a double folded into the result value (keeps the
+   * optimizer from discarding the work).
+   */
+  template <typename Setup, typename Body>
+  void run(const std::string& name, const std::string& instance, const double items,
+           Setup&& setup, Body&& body) {
+    if (!enabled(name)) return;
+
+    std::vector<double> samples;
+    double spent = 0.0, value = 0.0;
+    while (spent < minTimeSec || static_cast<long long>(samples.size()) < minIterations) {
+      setup();
+      auto start = Clock::now();
+      value = body();
+      double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+      samples.push_back(ns);
+      spent += ns * 1e-9;
+    }
+
+    BenchmarkResult r;
+    r.name = name;
+    r.instance = instance;
+    r.iterations = samples.size();
+    r.value = value;
+
+    double sum = 0.0;
+    for (double s : samples) sum += s;
+    r.meanNs = sum / samples.size();
+    double var = 0.0;
+    for (double s : samples) var += (s - r.meanNs) * (s - r.meanNs);
+    r.stddevNs = std::sqrt(var / samples.size());
+
+    std::sort(samples.begin(), samples.end());
+    r.minNs = samples.front();
+    r.maxNs = samples.back();
+    r.medianNs = samples[samples.size() / 2];
+    r.itemsPerSecond = r.meanNs > 0.0 ? items * 1e9 / r.meanNs : 0.0;
+
+    results.push_back(r);
+  }
+
+  template <typename Body>
+  void run(const std::string& name, const std::string& instance, const double items,
+           Body&& body) {
+    run(name, instance, items, [] {}, std::forward<Body>(body));
+  }
+
+  const std::vector<BenchmarkResult>& getResults() const { return results; }
+
+  void writeCSV(std::ostream& out) const {
+    out << "name,instance,iterations,mean_ns,median_ns,min_ns,max_ns,stddev_ns,"
+           "items_per_second,value\n";
+    for (const auto& r : results)
+      out << r.name << ',' << r.instance << ',' << r.iterations << ',' << r.meanNs << ','
+          << r.medianNs << ',' << r.minNs << ',' << r.maxNs << ',' << r.stddevNs << ','
+          << r.itemsPerSecond << ',' << r.value << '\n';
+  }
+
+  void writeJSON(std::ostream& out, const std::string& version) const {
+    out << "{\n  \"context\": {\"version\": \"" << version << "\", \"threads\": "
+        << std::thread::hardware_concurrency() << ", \"min_time_s\": " << minTimeSec
+        << "},\n  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+      const auto& r = results[i];
+      out << (i ? ",\n" : "\n") << "    {\"name\": \"" << r.name << "\", \"instance\": \""
+          << r.instance << "\", \"iterations\": " << r.iterations
+          << ", \"mean_ns\": " << r.meanNs << ", \"median_ns\": " << r.medianNs
+          << ", \"min_ns\": " << r.minNs << ", \"max_ns\": " << r.maxNs
+          << ", \"stddev_ns\": " << r.stddevNs << ", \"items_per_second\": " << r.itemsPerSecond
+          << ", \"value\": " << r.value << "}";
+    }
+    out << "\n  ]\n}\n";
+  }
+};
+
+#endif
@@ -0,0 +1,239 @@
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "algorithms/Solver.hpp"
+#include "models/SFP.hpp"
+#include "utils/CLI11.hpp"
+#include "utils/DSU.hpp"
+
+/**
+ * @file bench.cpp
+ * @brief steiner_forest_bench: micro benchmarks of the building blocks and
+ * macro benchmarks of the constructive and local search phases.
+ * * Every case is seeded, so the `value` column (path cost sums, solution
+ * costs) must match between versions that claim to be behavior-preserving.
+ */
+
+#ifndef SFP_SOURCE_DIR
+#define SFP_SOURCE_DIR "."
+#endif
+
+// One instance per family with a moderate run time
+static const std::vector<std::string> kDefaultInstances = {
+    "data/Sparse-Graphs/Incidence/I640/i640-242.stp",
+    "data/VLSI-Graphs/DIW/diw0559.stp",
+    "data/WireRouting-Graphs/WRP4/wrp4-47.stp",
+    "data/Rectilinear-Graphs/ES100FST/es100fst01.stp",
+};
+
+static constexpr unsigned int kSeed = 42;
+static constexpr int kQueries = 64;
+
+static std::string baseName(const std::string& path) {
+  size_t slash = path.find_last_of("/\\");
+  return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+/**
+ * @brief Undirected edge list of a CSR graph (input of the Graph constructor).
+ */
+static std::vector<std::tuple<int, int, float>> edgeListOf(const Graph& g) {
+  std::vector<std::tuple<int, int, float>> edgeList;
+  edgeList.reserve(g.nEdges / 2);
+  for (int i = 0; i < g.nEdges; ++i)
+    if (i < g.rev[i]) edgeList.push_back({g.edges[i].source, g.edges[i].target, g.weights[i]});
+  return edgeList;
+}
+
+static void benchGraph(BenchmarkRunner& runner, const SFPProblem& problem, const std::string& name) {
+  const auto graph = problem.getGraphPtr();
+  auto edgeList = edgeListOf(*graph);
+
+  runner.run("graph/build", name, edgeList.size(), [&] {
+    Graph g(edgeList, graph->nNodes);
+    return static_cast<double>(g.totalWeight);
+  });
+
+  DSU dsu(graph->nNodes);
+  runner.run("dsu/unite_find", name, edgeList.size() + graph->nNodes,
+             [&] { dsu.reset(); },
+             [&] {
+               for (const auto& edge : edgeList) dsu.unite(std::get<0>(edge), std::get<1>(edge));
+               double roots = 0;
+               for (int v = 0; v < graph->nNodes; ++v) roots += dsu.find(v) == v;
+               return roots;
+             });
+}
+
+static void benchDijkstra(BenchmarkRunner& runner, const SFPProblem& problem, const std::string& name) {
+  const auto graph = problem.getGraphPtr();
+  const auto& terminals = problem.getTerminals();
+
+  // Seeded node pairs, half terminal pairs and half random ones
+  std::mt19937 rng(kSeed);
+  std::uniform_int_distribution<int> node(0, graph->nNodes - 1);
+  std::vector<std::pair<int, int>> queries;
+  for (int q = 0; q < kQueries; ++q)
+    queries.push_back(q % 2 && !terminals.empty() ? terminals[q % terminals.size()]
+                                                  : std::make_pair(node(rng), node(rng)));
+
+  // Bridges on a random tenth of the edges, like a partial solution
+  EdgeMask state(graph->nEdges);
+  for (int i = 0; i < graph->nEdges; ++i)
+    if (i < graph->rev[i] && rng() % 10 == 0) state.set(i, graph->rev[i], EDGE_BRIDGE);
+
+  const std::map<std::string, QueueKind> queues{
+      {"binary", QueueKind::BINARY}, {"quad", QueueKind::QUATERNARY}, {"radix", QueueKind::RADIX}};
+
+  for (const auto& [queueName, queue] : queues) {
+    auto bidirectional = BidirectionalDijkstraEngine::create(graph, nullptr, queue);
+    runner.run("bidijkstra/" + queueName, name, kQueries, [&] {
+      double sum = 0;
+      for (const auto& [s, t] : queries) sum += bidirectional->getShortPath(s, t).second;
+      return sum;
+    });
+    runner.run("bidijkstra_bridges/" + queueName, name, kQueries, [&] {
+      double sum = 0;
+      for (const auto& [s, t] : queries) sum += bidirectional->getShortPath(s, t, &state).second;
+      return sum;
+    });
+
+    auto unidirectional = DijkstraEngine::create(graph, queue);
+    runner.run("dijkstra/" + queueName, name, kQueries, [&] {
+      double sum = 0;
+      for (const auto& [s, t] : queries) sum += unidirectional->getShortPath(s, t).second;
+      return sum;
+    });
+    runner.run("explore/" + queueName, name, graph->nNodes, [&] {
+      unidirectional->exploreFrom({queries[0].first});
+      return static_cast<double>(unidirectional->getDistance(queries[0].second));
+    });
+  }
+}
+
+static void benchSolver(BenchmarkRunner& runner, const SFPProblem& problem, const std::string& name,
+                        const float alpha) {
+  auto dijkstra = BidirectionalDijkstraEngine::create(problem.getGraphPtr());
+
+  std::mt19937 rng;
+  GRASPConstructiveHeuristic constructive(rng, dijkstra, alpha);
+  runner.run("construct/grasp", name, 1, [&] { rng.seed(kSeed); }, [&] {
+    return constructive.generate(&problem).getCurrentCost();
+  });
+
+  rng.seed(kSeed);
+  const SFPSolution start = constructive.generate(&problem);
+
+  // insert/erase: rebuild every pair path of the start solution, then drop it
+  std::vector<SolutionPair> pairs;
+  int nInserts = 0;
+  for (int p = 0; p < start.getNPairs(); ++p) {
+    auto [s, t] = start.getPairNodes(p);
+    pairs.emplace_back(s, t);
+    nInserts += start.getPairEdges(p)->size();
+  }
+  runner.run("solution/insert_erase", name, 2.0 * nInserts, [&] {
+    SFPSolution sol(&problem, pairs);
+    for (int p = 0; p < start.getNPairs(); ++p)
+      for (int edge : *start.getPairEdges(p)) sol.insert(edge, p);
+    double cost = sol.getCurrentCost();
+    for (int p = 0; p < start.getNPairs(); ++p)
+      for (int edge : *start.getPairEdges(p)) sol.erase(edge, p);
+    return cost;
+  });
+
+  // One optimize() pass from the same start solution
+  std::unique_ptr<SFPSolution> work;
+  GRASPLocalSearch grasp(dijkstra);
+  runner.run("ls/grasp_pass", name, 1, [&] { work = std::make_unique<SFPSolution>(start); }, [&] {
+    grasp.optimize(work.get());
+    return work->getCurrentCost();
+  });
+
+  HubBreakingLocalSearch hub(dijkstra);
+  runner.run("ls/hub_pass", name, 1, [&] { work = std::make_unique<SFPSolution>(start); }, [&] {
+    hub.optimize(work.get());
+    return work->getCurrentCost();
+  });
+
+  GRASPLocalSearch boundedGrasp(dijkstra, 1, QueueKind::AUTO, true);
+  runner.run("ls/grasp_bounded_pass", name, 1, [&] { work = std::make_unique<SFPSolution>(start); }, [&] {
+    boundedGrasp.optimize(work.get());
+    return work->getCurrentCost();
+  });
+
+  HubBreakingLocalSearch boundedHub(dijkstra, true);
+  runner.run("ls/hub_bounded_pass", name, 1, [&] { work = std::make_unique<SFPSolution>(start); }, [&] {
+    boundedHub.optimize(work.get());
+    return work->getCurrentCost();
+  });
+}
+
+int main(int argc, char** argv) {
+  CLI::App app{"Steiner Forest Problem Solver - benchmark suite"};
+
+  std::vector<std::string> instances;
+  std::string format = "json";
+  std::string output;
+  std::string filter;
+  double minTime = 0.5;
+  long long minIterations = 3;
+  float alpha = 0.5f;
+
+  app.add_option("-f,--file", instances, "Instances to benchmark (default: one per data family)")
+      ->check(CLI::ExistingFile);
+  app.add_option("--format", format, "Output format: json or csv")
+      ->check(CLI::IsMember({"json", "csv"}));
+  app.add_option("-o,--output", output, "Write the results to a file instead of stdout");
+  app.add_option("--filter", filter, "Only run cases whose name contains this string");
+  app.add_option("--min-time", minTime, "Timed seconds per case")->check(CLI::NonNegativeNumber);
+  app.add_option("--min-iterations", minIterations, "Iterations per case even past --min-time")
+      ->check(CLI::PositiveNumber);
+  app.add_option("-a,--alpha", alpha, "Alpha of the constructive cases")->check(CLI::Range(0.0, 1.0));
+
+  CLI11_PARSE(app, argc, argv);
+
+  if (instances.empty())
+    for (const auto& path : kDefaultInstances) instances.push_back(std::string(SFP_SOURCE_DIR) + "/" + path);
+
+  BenchmarkRunner runner(minTime, minIterations, filter);
+
+  for (const auto& path : instances) {
+    SFPProblem problem;
+    try {
+      problem.loadFile(path);
+    } catch (const std::exception& e) {
+      std::cerr << "[BENCH] Skipping " << path << ":\n" << e.what() << std::endl;
+      continue;
+    }
+
+    const std::string name = baseName(path);
+    std::cerr << "[BENCH] " << name << std::endl;
+    benchGraph(runner, problem, name);
+    benchDijkstra(runner, problem, name);
+    benchSolver(runner, problem, name, alpha);
+  }
+
+  std::ofstream file;
+  if (!output.empty()) {
+    file.open(output);
+    if (!file) {
+      std::cerr << "[BENCH] Cannot open " << output << std::endl;
+      return 1;
+    }
+  }
+  std::ostream& out = output.empty() ? std::cout : file;
+  out.precision(12);
+
+  if (format == "csv") runner.writeCSV(out);
+  else runner.writeJSON(out, "steiner_forest_bench");
+
+  return 0;
+}
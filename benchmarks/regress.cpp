@@ -0,0 +1,317 @@
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#include "algorithms/Batch.hpp"
+#include "utils/CLI11.hpp"
+#include "utils/Stats.hpp"
+
+/**
+ * @file regress.cpp
+ * @brief steiner_forest_regress: replays a fixed (instance, algorithm, seed)
+ * matrix and compares it with what earlier versions did.
+ * * Jobs run one at a time on one thread, so their cost and their
+ * instrumentation counters (SFP_STATS builds) are exact for a given code.
+ * Those machine-independent results are committed in
+ * benchmarks/regression/expected.csv: a grown work count fails the check,
+ * a changed cost is reported. Times only mean something on the machine that
+ * measured them, so they are compared with a baseline recorded by `--record`
+ * into the build directory, and only warn when that baseline was recorded on
+ * another host. Each job keeps its fastest of `--repeat` runs, whose costs
+ * must all agree.
+ */
+
+#ifndef SFP_SOURCE_DIR
+#define SFP_SOURCE_DIR "."
+#endif
+
+#ifndef SFP_BINARY_DIR
+#define SFP_BINARY_DIR "."
+#endif
+
+/**
+ * @struct RegressionJob
+ * @brief One row of the matrix, and of the result files once measured.
+ */
+struct RegressionJob {
+  std::string instance;  ///< Relative to the source tree
+  std::string algorithm;
+  unsigned int seed = 0;
+  int iterations = 1;
+
+  double cost = 0.0;
+  double timeMs = 0.0;
+  unsigned long long settled = 0;  ///< Settled nodes plus queue pushes (0 without SFP_STATS)
+  unsigned long long queries = 0;  ///< Shortest path queries (0 without SFP_STATS)
+  std::string host;                ///< Machine of a time baseline row
+
+  std::string key() const {
+    return instance + " " + algorithm + " " + std::to_string(seed) + " " + std::to_string(iterations);
+  }
+};
+
+static std::string label(const RegressionJob& job) {
+  size_t slash = job.instance.find_last_of("/\\");
+  std::string name = slash == std::string::npos ? job.instance : job.instance.substr(slash + 1);
+  return name.substr(0, name.find_last_of('.')) + " " + job.algorithm + " " + std::to_string(job.seed);
+}
+
+static std::string hostName() {
+#ifdef _WIN32
+  const char* name = std::getenv("COMPUTERNAME");
+  return name ? name : "unknown";
+#else
+  char name[256] = {};
+  if (gethostname(name, sizeof(name) - 1) != 0) return "unknown";
+  return name;
+#endif
+}
+
+static std::vector<RegressionJob> readMatrix(const std::string& path) {
+  std::ifstream in(path);
+  if (!in.is_open()) throw std::runtime_error("\tThe matrix cannot be opened: " + path);
+
+  std::vector<RegressionJob> jobs;
+  std::string line;
+  int lineNumber = 0;
+  while (std::getline(in, line)) {
+    lineNumber++;
+    size_t first = line.find_first_not_of(" \t\r");
+    if (first == std::string::npos || line[first] == '#') continue;
+    RegressionJob job;
+    std::istringstream fields(line);
+    if (!(fields >> job.instance >> job.algorithm >> job.seed >> job.iterations) ||
+        (job.algorithm != "GRASP" && job.algorithm != "HUB") || job.iterations <= 0)
+      throw std::runtime_error("\tLine " + std::to_string(lineNumber) + ": expected <instance> <GRASP|HUB> <seed> <restarts>");
+    jobs.push_back(job);
+  }
+  return jobs;
+}
+
+/**
+ * @brief Reads a result file: expected.csv (cost and work) or a time baseline.
+ */
+static std::vector<RegressionJob> readResults(const std::string& path, const bool timed) {
+  std::ifstream in(path);
+  if (!in.is_open()) throw std::runtime_error("\tThe result file cannot be opened: " + path);
+
+  std::vector<RegressionJob> jobs;
+  std::string line;
+  std::getline(in, line);  // Header
+  while (std::getline(in, line)) {
+    if (line.empty()) continue;
+    std::replace(line.begin(), line.end(), ',', ' ');
+    RegressionJob job;
+    std::istringstream fields(line);
+    bool ok = static_cast<bool>(fields >> job.instance >> job.algorithm >> job.seed >> job.iterations >> job.cost);
+    if (timed) ok = ok && (fields >> job.timeMs >> job.host);
+    else ok = ok && (fields >> job.settled >> job.queries);
+    if (!ok) throw std::runtime_error("\tMalformed line of " + path + ": " + line);
+    jobs.push_back(job);
+  }
+  return jobs;
+}
+
+static void writeResults(const std::string& path, const std::vector<RegressionJob>& jobs, const bool timed) {
+  std::ofstream out(path);
+  if (!out.is_open()) throw std::runtime_error("\tThe result file cannot be written: " + path);
+  out << "instance,algorithm,seed,iterations,cost," << (timed ? "time_ms,host" : "settled_and_pushes,queries")
+      << "\n";
+  out << std::setprecision(12);
+  const std::string host = hostName();
+  for (const auto& job : jobs) {
+    out << job.instance << ',' << job.algorithm << ',' << job.seed << ',' << job.iterations << ',' << job.cost;
+    if (timed) out << ',' << job.timeMs << ',' << host << '\n';
+    else out << ',' << job.settled << ',' << job.queries << '\n';
+  }
+}
+
+static const RegressionJob* find(const std::vector<RegressionJob>& rows, const RegressionJob& job) {
+  auto it = std::find_if(rows.begin(), rows.end(), [&](const RegressionJob& row) { return row.key() == job.key(); });
+  return it == rows.end() ? nullptr : &*it;
+}
+
+/**
+ * @brief Runs a job `repeat` times and keeps its fastest run.
+ * @return false if the repeats did not all reach the same cost.
+ */
+static bool measure(RegressionJob& job, const std::string& root, const int repeat) {
+  SolverConfig config;
+  config.maxIterations = job.iterations;
+  config.seed = job.seed;
+
+  bool stable = true;
+  for (int r = 0; r < repeat; ++r) {
+    const Stats::Block before = Stats::total();
+    BatchResult result;
+    BatchRunner(config, 1).run({root + "/" + job.instance}, {job.algorithm}, {job.seed},
+                               [&](const BatchResult& done) { result = done; });
+    if (!result.error.empty()) throw std::runtime_error(result.error);
+    const Stats::Block after = Stats::total();
+
+    auto delta = [&](const StatCounter c) {
+      return after.counters[static_cast<int>(c)] - before.counters[static_cast<int>(c)];
+    };
+    if (r == 0) {
+      job.cost = result.cost;
+      job.timeMs = result.timeMs;
+      job.settled = delta(StatCounter::SETTLED_NODES) + delta(StatCounter::HEAP_PUSHES);
+      job.queries = delta(StatCounter::BIDIJKSTRA_QUERIES) + delta(StatCounter::DIJKSTRA_QUERIES);
+    } else {
+      stable = stable && result.cost == job.cost;
+      job.timeMs = std::min(job.timeMs, result.timeMs);
+    }
+  }
+  return stable;
+}
+
+int main(int argc, char** argv) {
+  CLI::App app{"Steiner Forest Problem Solver - performance regression harness"};
+
+  const std::string dir = std::string(SFP_SOURCE_DIR) + "/benchmarks/regression";
+  std::string matrix = dir + "/matrix.txt";
+  std::string expectedPath = dir + "/expected.csv";
+  std::string baseline = std::string(SFP_BINARY_DIR) + "/regress-baseline.csv";
+  std::string root = SFP_SOURCE_DIR;
+  double threshold = 0.10;
+  int repeat = 3;
+  bool record = false;
+  bool recordExpected = false;
+  bool strictCost = false;
+
+  app.add_option("--matrix", matrix, "Jobs to replay: <instance> <GRASP|HUB> <seed> <restarts> per line");
+  app.add_option("--expected", expectedPath, "Machine-independent costs and work counters to compare with");
+  app.add_option("--baseline", baseline, "Time baseline of this machine (default: in the build directory)");
+  app.add_option("--root", root, "Directory the matrix instances are relative to (default: the source tree)");
+  app.add_option("--threshold", threshold, "Allowed relative growth of the total time and work")
+      ->check(CLI::NonNegativeNumber);
+  app.add_option("--repeat", repeat, "Runs per job, the fastest one is kept")->check(CLI::PositiveNumber);
+  app.add_flag("--record", record, "Writes the measured times as the baseline of this machine");
+  app.add_flag("--record-expected", recordExpected, "Rewrites --expected (SFP_STATS builds only)");
+  app.add_flag("--strict-cost", strictCost, "Also fails when a job cost differs from --expected");
+
+  CLI11_PARSE(app, argc, argv);
+
+  std::vector<RegressionJob> jobs, expected, timed;
+  try {
+    if (recordExpected && !Stats::kEnabled)
+      throw std::runtime_error("\t--record-expected needs the work counters of a -DSFP_STATS=ON build.");
+    jobs = readMatrix(matrix);
+    if (!recordExpected) expected = readResults(expectedPath, false);
+    if (!record && std::ifstream(baseline).good()) timed = readResults(baseline, true);
+  } catch (const std::exception& e) {
+    std::cerr << "[REGRESS] " << e.what() << std::endl;
+    return 2;
+  }
+
+  bool failed = false;
+  int costChanges = 0;
+  double totalMs = 0.0, baseMs = 0.0;
+  unsigned long long totalWork = 0, baseWork = 0;
+  std::string baseHost;
+
+  std::cout << std::left << std::setw(28) << "job" << std::right << std::setw(16) << "cost" << std::setw(16)
+            << "expected" << std::setw(10) << "work" << std::setw(12) << "ms" << std::setw(12) << "base ms"
+            << std::setw(9) << "ratio" << std::endl;
+  for (auto& job : jobs) {
+    try {
+      if (!measure(job, root, repeat)) {
+        std::cout << "[REGRESS] Non-deterministic cost: " << label(job) << std::endl;
+        failed = true;
+      }
+    } catch (const std::exception& e) {
+      std::cerr << "[REGRESS] " << label(job) << ":\n" << e.what() << std::endl;
+      return 2;
+    }
+
+    const RegressionJob* reference = find(expected, job);
+    const RegressionJob* base = find(timed, job);
+    std::cout << std::left << std::setw(28) << label(job) << std::right << std::fixed << std::setprecision(4)
+              << std::setw(16) << job.cost;
+    if (reference) std::cout << std::setw(16) << reference->cost;
+    else std::cout << std::setw(16) << "-";
+
+    // Work is only compared when both sides were instrumented
+    if (reference && job.settled && reference->settled) {
+      totalWork += job.settled;
+      baseWork += reference->settled;
+      std::cout << std::setprecision(3) << std::setw(10) << static_cast<double>(job.settled) / reference->settled;
+    } else {
+      std::cout << std::setw(10) << "-";
+    }
+
+    std::cout << std::setprecision(2) << std::setw(12) << job.timeMs;
+    if (base) {
+      totalMs += job.timeMs;
+      baseMs += base->timeMs;
+      if (baseHost.empty()) baseHost = base->host;
+      std::cout << std::setw(12) << base->timeMs << std::setw(9) << job.timeMs / base->timeMs;
+    } else {
+      std::cout << std::setw(12) << "-" << std::setw(9) << "-";
+    }
+
+    const bool costChanged = reference && reference->cost != job.cost;
+    costChanges += costChanged;
+    std::cout << (costChanged ? "  cost changed" : !reference && !recordExpected ? "  (not expected)" : "")
+              << std::endl;
+  }
+
+  try {
+    if (recordExpected) {
+      writeResults(expectedPath, jobs, false);
+      std::cout << "[REGRESS] Expected costs and work written to " << expectedPath << std::endl;
+    }
+    if (record) {
+      writeResults(baseline, jobs, true);
+      std::cout << "[REGRESS] Time baseline written to " << baseline << std::endl;
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "[REGRESS] " << e.what() << std::endl;
+    return 2;
+  }
+  if (record || recordExpected) return failed ? 1 : 0;
+
+  std::cout << std::setprecision(3);
+  if (baseWork > 0) {
+    const double ratio = static_cast<double>(totalWork) / baseWork;
+    std::cout << "[REGRESS] Work (settled nodes + pushes): x" << ratio << std::endl;
+    if (ratio > 1.0 + threshold) {
+      std::cout << "[REGRESS] Work grew beyond " << threshold * 100 << "%" << std::endl;
+      failed = true;
+    }
+  } else if (!Stats::kEnabled) {
+    std::cout << "[REGRESS] No work counters in this build, configure with -DSFP_STATS=ON to check them"
+              << std::endl;
+  }
+
+  if (baseMs > 0.0) {
+    const double ratio = totalMs / baseMs;
+    const bool sameHost = baseHost == hostName();
+    std::cout << "[REGRESS] Time: " << totalMs << " ms against " << baseMs << " ms (x" << ratio << ")"
+              << (sameHost ? "" : ", baseline recorded on " + baseHost) << std::endl;
+    if (ratio > 1.0 + threshold) {
+      std::cout << "[REGRESS] Throughput dropped beyond " << threshold * 100 << "%"
+                << (sameHost ? "" : " (warning only, other host)") << std::endl;
+      failed = failed || sameHost;
+    }
+  } else {
+    std::cout << "[REGRESS] No time baseline at " << baseline << ", --record one to check times" << std::endl;
+  }
+
+  if (costChanges) {
+    std::cout << "[REGRESS] " << costChanges << " job(s) changed cost" << std::endl;
+    failed = failed || strictCost;
+  }
+
+  std::cout << (failed ? "[REGRESS] FAILED" : "[REGRESS] OK") << std::endl;
+  return failed ? 1 : 0;
+}
@@ -4,12 +4,26 @@
 #include <cstddef>
 #include <cstdlib>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <limits>
+#include <map>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
 
 #include "tests/Tests.hpp"
+#include "models/Reduction.hpp"
 #include "models/SFP.hpp"
+#include "algorithms/Batch.hpp"
 #include "algorithms/Solver.hpp"
 #include "utils/CLI11.hpp"
+#include "utils/Stats.hpp"
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
 
 std::string getFileName(const std::string& path) {
     size_t lastSlash = path.find_last_of("/\\");
@@ -23,6 +37,29 @@ bool hasExtension(const std::string& str, const std::string& suffix) {
     return tmp_str.compare(tmp_str.length() - suffix.length(), suffix.length(), suffix) == 0;
 }
 
+/**
+ * @brief Peak resident set size of the process in bytes, 0 where unknown.
+ */
+size_t peakResidentBytes() {
+#ifdef _WIN32
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return usage.ru_maxrss;
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+std::string formatBytes(const size_t bytes) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3) << bytes / (1024.0 * 1024.0) << " MiB";
+    return out.str();
+}
+
 void panic(const std::string& msg) {
     std::cerr << "\n========================================" << std::endl;
     std::cerr << "[FATAL ERROR]: " << msg << std::endl;
@@ -39,6 +76,7 @@ int main(int argc, char** argv) {
   bool flag_test_dijkstra = false;
   bool flag_test_bidijkstra = false;
   bool flag_test_SFP = false;
+  bool flag_test_solver = false;
 
   app.add_flag("--test", flag_test_all, "Runs all available tests");
   app.add_flag("--test-graph", flag_test_graph,
@@ -50,33 +88,109 @@ int main(int argc, char** argv) {
           "Runs only the Bidirectional Dijkstra algorithm tests");
   app.add_flag("--test-sfp", flag_test_SFP,
                "Runs only the Steiner Forest Problem implementation tests");
+  app.add_flag("--test-solver", flag_test_solver,
+               "Runs only the metaheuristic solver tests");
 
   std::string input_file;
+  std::string compiled_file;
+  std::string saved_solution;
+  std::string warm_start;
+  std::string stats_format;
+  std::string batch_source;
+  std::string batch_format = "csv";
+  std::string batch_output;
+  std::vector<unsigned int> seeds;
+  unsigned int seed = std::random_device{}();
+  int nJobs = std::max(1u, std::thread::hardware_concurrency());
   float alpha = 1.0f;
   int maxIter = 1;
+  int nThreads = 1;
+  int lsThreads = 1;
+  int nLandmarks = 0;
+  int eliteSize = 0;
+  int relinkPeriod = 4;
+  int hubTopK = 0;
+  QueueKind queue = QueueKind::AUTO;
   bool flag_irace = false;
   bool flag_grasp = false;
   bool flag_hubBreak = false;
+  bool flag_boundedRepair = false;
+  bool flag_firstImprovement = false;
+  bool flag_incumbents = false;
+  bool flag_reduce = false;
+  bool flag_memory = false;
+  double timeLimitMs = 0.0;
+  double targetCost = -std::numeric_limits<double>::infinity();
 
   app.add_flag("--IRACE", flag_irace, "Runs for tuning");
   app.add_flag("--GRASP", flag_grasp, "Runs GRASP-SFP metaheuristic");
   app.add_flag("--HUB", flag_hubBreak, "Runs GRASP and Hubs Break metaheuristic");
-  app.add_option("-f,--file", input_file, "Path to a single .stp file to solve")
+  app.add_option("-f,--file", input_file, "Path to a single .stp or .sfpb file to solve")
+      ->check(CLI::ExistingFile);
+  app.add_option("--compile-instance", compiled_file,
+                 "Writes the -f instance as a binary .sfpb snapshot and exits");
+  app.add_option("--save-solution", saved_solution, "Writes the final solution to a solution file");
+  app.add_option("--warm-start", warm_start,
+                 "Starts from a saved solution, repairing the pairs it no longer covers")
       ->check(CLI::ExistingFile);
+  app.add_option("--stats", stats_format, "Writes the instrumentation counters to stderr (builds with -DSFP_STATS=ON)")
+      ->check(CLI::IsMember({"json"}));
+  app.add_option("--batch", batch_source,
+                 "Solves every instance of a directory or manifest file, one result line per job");
+  app.add_option("--seed", seed, "Seed of every random stream of the run (default: random, printed in the summary)");
+  app.add_option("--seeds", seeds, "Seeds of the batch jobs, e.g. 1,2,3 (default: the --seed one)")
+      ->delimiter(',');
+  app.add_option("-j,--jobs", nJobs, "Batch jobs run concurrently (default: hardware threads)")
+      ->check(CLI::PositiveNumber);
+  app.add_option("--batch-format", batch_format, "Batch result lines: csv or json")
+      ->check(CLI::IsMember({"csv", "json"}));
+  app.add_option("-o,--output", batch_output, "Writes the batch results to a file instead of stdout");
   app.add_option("-a,--alpha", alpha, "Alpha parameter for constructive heuristic")
       ->check(CLI::Range(0.0, 1.0));
   app.add_option("-i,--iterations", maxIter, "The limit of iterations of the metaheuristic")
       ->check(CLI::PositiveNumber);
+  app.add_option("-t,--threads", nThreads, "Worker threads sharing the metaheuristic restarts")
+      ->check(CLI::PositiveNumber);
+  app.add_option("--ls-threads", lsThreads, "Threads evaluating the GRASP local search moves of each worker")
+      ->check(CLI::PositiveNumber);
+  app.add_flag("--bounded-repair", flag_boundedRepair,
+               "Local search repairs with cost and hop bounded searches");
+  app.add_option("--hub-top-k", hubTopK, "Most unstable hubs tried per HUB local search pass (0 tries all)")
+      ->check(CLI::NonNegativeNumber);
+  app.add_flag("--first-improvement", flag_firstImprovement,
+               "HUB local search passes end at their first improving move");
+  app.add_option("--time-limit", timeLimitMs, "Wall-clock budget of the metaheuristic in ms (0 disables)")
+      ->check(CLI::NonNegativeNumber);
+  app.add_option("--target-cost", targetCost, "Stops the metaheuristic once a solution this cheap is found");
+  app.add_flag("--trace-incumbents", flag_incumbents,
+               "Writes every new best solution of the metaheuristic to stderr, with its time");
+  app.add_flag("--memory-report", flag_memory,
+               "Prints the memory held by the graph, engines and solution after the summary");
+  app.add_flag("--reduce", flag_reduce,
+               "Removes useless leaves, degree-2 chains and long edges before solving");
+  app.add_option("--elite", eliteSize, "Elite solutions kept for path relinking (0 disables)")
+      ->check(CLI::NonNegativeNumber);
+  app.add_option("--relink-period", relinkPeriod, "Restarts of each worker between two path relinkings")
+      ->check(CLI::PositiveNumber);
+  app.add_option("-L,--landmarks", nLandmarks, "ALT landmarks used by the Dijkstra engines (0 disables)")
+      ->check(CLI::NonNegativeNumber);
+  const std::map<std::string, QueueKind> queueNames{
+      {"auto", QueueKind::AUTO}, {"binary", QueueKind::BINARY},
+      {"quad", QueueKind::QUATERNARY}, {"radix", QueueKind::RADIX}};
+  app.add_option("--queue", queue, "Priority queue of the Dijkstra engines: auto, binary, quad or radix")
+      ->transform(CLI::CheckedTransformer(queueNames, CLI::ignore_case));
 
   CLI11_PARSE(app, argc, argv);
   
-  if (flag_test_all || flag_test_graph || flag_test_dijkstra || flag_test_SFP || flag_test_DSU) {
+  if (flag_test_all || flag_test_graph || flag_test_dijkstra || flag_test_bidijkstra ||
+      flag_test_SFP || flag_test_DSU || flag_test_solver) {
     if (flag_test_all) {
       graphTests();
       dijkstraTests();
       BidirectionalDijkstraTests();
       dsuTests();
       steinerForestTests();
+      solverTests();
       return 0;
     }
     if (flag_test_graph) graphTests();
@@ -84,46 +198,173 @@ int main(int argc, char** argv) {
     if (flag_test_bidijkstra) BidirectionalDijkstraTests();
     if (flag_test_DSU) dsuTests();
     if (flag_test_SFP) steinerForestTests();
+    if (flag_test_solver) solverTests();
+    return 0;
+  }
+  else if (!batch_source.empty()) {
+    if (!stats_format.empty() && !Stats::kEnabled)
+      panic("--stats needs a build configured with -DSFP_STATS=ON.");
+    // Options of a single run only, silently dropping them would mislead
+    for (const std::string name : {"--file", "--compile-instance", "--save-solution", "--warm-start",
+                                   "--IRACE", "--trace-incumbents", "--memory-report", "--reduce"})
+      if (app.count(name) > 0) panic(name + " applies to a single run, it cannot be combined with --batch.");
+
+    std::vector<std::string> instances;
+    try { instances = BatchRunner::listInstances(batch_source); }
+    catch (const std::exception& e) { panic("Error listing the batch instances\n" + std::string(e.what())); }
+
+    std::vector<std::string> algorithms;
+    if (flag_grasp) algorithms.push_back("GRASP");
+    if (flag_hubBreak) algorithms.push_back("HUB");
+    if (algorithms.empty()) algorithms.push_back("CONSTRUCTIVE");
+    if (seeds.empty()) seeds.push_back(seed);
+
+    SolverConfig config;
+    config.maxIterations = maxIter;
+    config.alpha = alpha;
+    config.nThreads = nThreads;
+    config.nLandmarks = nLandmarks;
+    config.queue = queue;
+    config.lsThreads = lsThreads;
+    config.boundedRepair = flag_boundedRepair;
+    config.hubTopK = hubTopK;
+    config.firstImprovement = flag_firstImprovement;
+    config.timeLimitMs = timeLimitMs;
+    config.targetCost = targetCost;
+    config.eliteSize = eliteSize;
+    config.relinkPeriod = relinkPeriod;
+
+    std::ofstream file;
+    if (!batch_output.empty()) {
+      file.open(batch_output);
+      if (!file) panic("The file cannot be created: " + batch_output);
+    }
+    std::ostream& out = batch_output.empty() ? std::cout : file;
+    out.precision(12);
+
+    if (batch_format == "csv") BatchRunner::writeCSVHeader(out);
+    BatchRunner(config, nJobs).run(instances, algorithms, seeds, [&](const BatchResult& result) {
+      if (batch_format == "csv") BatchRunner::writeCSV(out, result);
+      else BatchRunner::writeJSON(out, result);
+    });
+
+    if (!stats_format.empty()) Stats::writeJSON(std::cerr);
     return 0;
   }
   else if(!input_file.empty()){
-    if(!hasExtension(input_file, ".stp")){ panic("The file extension must be '.stp'."); }
+    if(!hasExtension(input_file, ".stp") && !hasExtension(input_file, ".sfpb")){
+      panic("The file extension must be '.stp' or '.sfpb'.");
+    }
+
+    if (!stats_format.empty() && !Stats::kEnabled)
+      panic("--stats needs a build configured with -DSFP_STATS=ON.");
 
-    std::ifstream file(input_file);
-    if (!file.is_open()) { panic("The file cannot be opened"); }
-    
     SFPProblem problem;
-    try { file >> problem;} 
+    try { problem.loadFile(input_file); } 
     catch (const std::exception& e) { panic("Error parsing file\n" + std::string(e.what())); }
+
+    if (!compiled_file.empty()) {
+      try { problem.saveBinary(compiled_file); }
+      catch (const std::exception& e) { panic("Error compiling instance\n" + std::string(e.what())); }
+      return 0;
+    }
     
+    if (flag_reduce && !warm_start.empty())
+      panic("--warm-start solutions refer to the original graph, it cannot be combined with --reduce.");
+
+    // The solvers work on the reduced copy, solutions are expanded back
+    std::unique_ptr<SFPReduction> reduction;
+    double reductionMs = 0.0;
+    if (flag_reduce) {
+      auto start = std::chrono::high_resolution_clock::now();
+      try { reduction = std::make_unique<SFPReduction>(problem); }
+      catch (const std::exception& e) { panic("Error reducing the instance\n" + std::string(e.what())); }
+      reductionMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+    const SFPProblem& instance = reduction ? reduction->getReduced() : problem;
+
+    std::shared_ptr<SFPSnapshot> previous;
+    if (!warm_start.empty()) {
+      previous = std::make_shared<SFPSnapshot>();
+      try { previous->load(warm_start, problem); }
+      catch (const std::exception& e) { panic("Error parsing solution file\n" + std::string(e.what())); }
+    }
+
     double firstSolutionCost = 0.0f, solutionCost = 0.0f, timeMs = 0.0f; 
+    SFPSnapshot snapshot;
+    // Engines and tables of the run, kept for the memory report
+    auto resources = std::make_shared<SolverResources>();
+    size_t solutionBytes = 0;
     if(!flag_grasp && !flag_hubBreak){
-        static std::random_device rd; static std::mt19937 rng(rd()); 
-        auto generate = std::make_unique<GRASPConstructiveHeuristic>(rng, nullptr, alpha);
+        std::mt19937 rng(seed);
+        std::shared_ptr<const Landmarks>& landmarks = resources->landmarks;
+        if (nLandmarks > 0)
+          landmarks = std::make_shared<const Landmarks>(instance.getGraphPtr(), nLandmarks);
+        auto dijkstra = BidirectionalDijkstraEngine::create(instance.getGraphPtr(), landmarks, queue);
+        resources->engines.push_back(dijkstra);
+        std::unique_ptr<ConstructiveStrategy> generate;
+        if (previous) generate = std::make_unique<WarmStartHeuristic>(previous, dijkstra, queue);
+        else generate = std::make_unique<GRASPConstructiveHeuristic>(rng, dijkstra, alpha, true, queue);
         auto start = std::chrono::high_resolution_clock::now();
-        auto solution = generate->generate(&problem);
+        auto solution = generate->generate(&instance);
         auto end = std::chrono::high_resolution_clock::now();
-        
+        if (reduction) solution = reduction->expand(solution);
+
         if(!solution.isFeasible()) panic("No valid solution was found.");
         firstSolutionCost = solution.getCurrentCost();
         solutionCost = firstSolutionCost;
         timeMs = std::chrono::duration<double, std::milli>(end - start).count();
+        snapshot.capture(solution);
+        solutionBytes = solution.memoryBytes();
     }
     else {
+        SolverConfig config;
+        config.maxIterations = maxIter;
+        config.alpha = alpha;
+        config.nThreads = nThreads;
+        config.nLandmarks = nLandmarks;
+        config.queue = queue;
+        config.lsThreads = lsThreads;
+        config.boundedRepair = flag_boundedRepair;
+        config.hubTopK = hubTopK;
+        config.firstImprovement = flag_firstImprovement;
+        config.warmStart = previous;
+        config.timeLimitMs = timeLimitMs;
+        config.targetCost = targetCost;
+        config.eliteSize = eliteSize;
+        config.relinkPeriod = relinkPeriod;
+        config.seed = seed;
+        if (flag_incumbents)
+          config.onIncumbent = [](const Incumbent& incumbent) {
+            std::cerr << "[INCUMBENT] " << std::fixed << std::setprecision(3) << incumbent.elapsedMs
+                      << " ms  cost " << std::setprecision(4) << incumbent.cost
+                      << "  iteration " << incumbent.iteration << std::endl;
+          };
+
         std::unique_ptr<SolverStrategy> metaheuristic;
-        if (flag_grasp) metaheuristic = std::make_unique<Metaheuristics<GRASPLocalSearch>>(&problem, maxIter, alpha);
-        else metaheuristic = std::make_unique<Metaheuristics<HubBreakingLocalSearch>>(&problem, maxIter, alpha);
+        if (flag_grasp) metaheuristic = std::make_unique<Metaheuristics<GRASPLocalSearch>>(&instance, config, resources);
+        else metaheuristic = std::make_unique<Metaheuristics<HubBreakingLocalSearch>>(&instance, config, resources);
         
         auto start = std::chrono::high_resolution_clock::now();
         auto solution = metaheuristic->solve();
         auto end = std::chrono::high_resolution_clock::now();
+        if (reduction) solution = reduction->expand(solution);
 
         if(!solution.isFeasible()) panic("No valid solution was found.");
         firstSolutionCost = metaheuristic->getFirstCost();
         solutionCost = solution.getCurrentCost();
         timeMs = std::chrono::duration<double, std::milli>(end - start).count();
+        snapshot.capture(solution);
+        solutionBytes = solution.memoryBytes();
     }
     
+    if (!saved_solution.empty()) {
+      try { snapshot.save(saved_solution, problem); }
+      catch (const std::exception& e) { panic("Error saving solution\n" + std::string(e.what())); }
+    }
+
+    if (!stats_format.empty()) Stats::writeJSON(std::cerr);
+
     if(flag_irace){ std::cout << solutionCost ; return 0; }
 
     std::string filename = getFileName(input_file);
@@ -137,12 +378,39 @@ int main(int argc, char** argv) {
     std::cout << std::left << std::setw(20) << "Nodes:"         << nNodes << std::endl;
     std::cout << std::left << std::setw(20) << "Edges:"         << nEdges << std::endl;
     std::cout << std::left << std::setw(20) << "Terminals:"     << nTerminals << std::endl;
+    if (reduction) {
+      const auto& reduced = reduction->getStats();
+      std::cout << std::left << std::setw(20) << "Reduced Nodes:" << reduced.nodesAfter << std::endl;
+      std::cout << std::left << std::setw(20) << "Reduced Edges:" << 2 * reduced.edgesAfter << std::endl;
+      std::cout << std::left << std::setw(20) << "Reduction Time:" << std::fixed << std::setprecision(3) << reductionMs << " ms" << std::endl;
+    }
     std::cout << std::left << std::setw(20) << "Alpha Used:"    << std::fixed << std::setprecision(2) << alphaUsed << std::endl;
+    std::cout << std::left << std::setw(20) << "Seed:"          << seed << std::endl;
     std::cout << "---------------------------------------------------" << std::endl;
     std::cout << std::left << std::setw(20) << "First Solution Cost:" << std::fixed << std::setprecision(4) << firstSolutionCost << std::endl;
     std::cout << std::left << std::setw(20) << "Solution Cost:" << std::fixed << std::setprecision(4) << solutionCost << std::endl;
     std::cout << std::left << std::setw(20) << "Execution Time:" << std::fixed << std::setprecision(3) << timeMs << " ms" << std::endl;
     std::cout << "===================================================\n" << std::endl;
+
+    if (flag_memory) {
+      size_t engineBytes = 0;
+      for (const auto& engine : resources->engines) engineBytes += engine->memoryBytes();
+      std::cout << "================== MEMORY REPORT ==================" << std::endl;
+      std::cout << std::left << std::setw(20) << "Graph:" << formatBytes(instance.getGraphPtr()->memoryBytes()) << std::endl;
+      if (reduction)
+        std::cout << std::left << std::setw(20) << "Original Graph:" << formatBytes(problem.getGraphPtr()->memoryBytes()) << std::endl;
+      if (resources->landmarks)
+        std::cout << std::left << std::setw(20) << "Landmarks:" << formatBytes(resources->landmarks->memoryBytes()) << std::endl;
+      std::cout << std::left << std::setw(20) << "Path Engines:" << formatBytes(engineBytes) << " ("
+                << resources->engines.size() << " x " << formatBytes(engineBytes / std::max<size_t>(1, resources->engines.size())) << ")" << std::endl;
+      if (resources->pathCache)
+        std::cout << std::left << std::setw(20) << "Path Cache:" << resources->pathCache->size() << " edges" << std::endl;
+      std::cout << std::left << std::setw(20) << "Solution:" << formatBytes(solutionBytes) << std::endl;
+      std::cout << std::left << std::setw(20) << "Snapshot:" << formatBytes(snapshot.memoryBytes()) << std::endl;
+      if (size_t peak = peakResidentBytes())
+        std::cout << std::left << std::setw(20) << "Peak RSS:" << formatBytes(peak) << std::endl;
+      std::cout << "===================================================\n" << std::endl;
+    }
   
     return 0;
   }
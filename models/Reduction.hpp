@@ -0,0 +1,62 @@
+#ifndef REDUCTION_HPP
+#define REDUCTION_HPP
+
+#include <vector>
+
+#include "SFP.hpp"
+
+/**
+ * @struct ReductionStats
+ * @brief What the reductions removed (undirected edge counts).
+ */
+struct ReductionStats {
+  int nodesBefore = 0, nodesAfter = 0;
+  int edgesBefore = 0, edgesAfter = 0;
+  int leaves = 0;      ///< Non-terminal degree-1 nodes removed
+  int contracted = 0;  ///< Non-terminal degree-2 nodes replaced by one edge
+  int longEdges = 0;   ///< Edges no cheaper than another path between their ends
+};
+
+/**
+ * @class SFPReduction
+ * @brief Reduced copy of a problem, and the way back to its edges.
+ * * Standard Steiner reductions, in rounds until none fires or for at most 4
+ * rounds, the later ones removing far less: parallel edges keep the cheapest
+ * one, an edge is dropped when a bounded search finds another path not longer
+ * than it (long-edge test), non-terminal leaves are removed and non-terminal
+ * degree-2 nodes are contracted into a single edge. None of
+ * them removes every optimal forest. The surviving nodes are renumbered into
+ * a new CSR graph, and every reduced edge remembers the original edges it
+ * stands for, so solutions of the reduced problem can be expanded back.
+ */
+class SFPReduction {
+ private:
+  const SFPProblem* original;
+  SFPProblem reduced;
+  std::vector<int> originalNode;              ///< Reduced node -> original node
+  std::vector<std::vector<int>> originalPath; ///< Reduced edge -> original edges, in its direction
+  ReductionStats stats;
+
+ public:
+  /**
+   * @brief Runs the reductions. `original` must outlive this object.
+   */
+  explicit SFPReduction(const SFPProblem& original);
+
+  const SFPProblem& getReduced() const { return reduced; }
+  const ReductionStats& getStats() const { return stats; }
+
+  /// Original edges of a reduced edge, from its source to its target
+  const std::vector<int>& getOriginalPath(const int edge_id) const { return originalPath[edge_id]; }
+  int getOriginalNode(const int node) const { return originalNode[node]; }
+
+  /**
+   * @brief Rebuilds a solution of the reduced problem on the original one,
+   * with the same pairs (in original node ids).
+   * * Contracted edges weigh the float sum of their original edges, so the
+   * cost is the same for integer weights and may differ by rounding otherwise.
+   */
+  SFPSolution expand(const SFPSolution& solution) const;
+};
+
+#endif
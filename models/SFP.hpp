@@ -1,13 +1,16 @@
 #ifndef SFP_HPP
 #define SFP_HPP
 
+#include <algorithm>
 #include <cstdint>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "../utils/EdgeMask.hpp"
 #include "../utils/Graph.hpp"
 
 // Forward declarations
@@ -24,13 +27,18 @@ struct SolutionEdge {
   double weight;   ///< Edge weight
   mutable std::vector<int> pairs;  ///< list of pairs that the edge connects (int::ptr -> SFPSolution.pairs)
 
-  SolutionEdge(const int id, const int reverse_id, const double relative_weight)
-      : id(id), reverse_id(reverse_id), weight(relative_weight) {
+  /**
+   * @param storage Recycled pair list, its capacity is kept.
+   */
+  SolutionEdge(const int id, const int reverse_id, const double relative_weight,
+               std::vector<int> storage = {})
+      : id(id), reverse_id(reverse_id), weight(relative_weight), pairs(std::move(storage)) {
     if (reverse_id != -1 && id > reverse_id) {
       this->id = reverse_id;
       this->reverse_id = id;
     }
-    pairs.reserve(10);
+    pairs.clear();
+    if (pairs.capacity() < 10) pairs.reserve(10);
   }
 
   bool operator==(const SolutionEdge& other) const {
@@ -50,22 +58,54 @@ struct SolutionPair {
   int synergy;          ///< Sum of intersections
   mutable std::vector<int>
       edges;  ///< list of edges that connect the pair (int::ptr -> Graph.edges)
-  mutable std::vector<int>
-      competing_pairs_sum;  ///< list with the sum of intersections with other
-                            //< pairs
+  mutable std::vector<std::pair<int, int>>
+      competitors;  ///< sorted {pair id, shared edges} of the overlapping
+                    //< pairs only
 
-  SolutionPair(const int source, const int target, const int nTerms)
+  SolutionPair(const int source, const int target)
       : source(source),
         target(target),
         pathCost(0.0f),
-        synergy(0),
-        competing_pairs_sum(std::vector<int>(nTerms, 0)) {
+        synergy(0) {
     if (source > target) {
       this->source = target;
       this->target = source;
     }
     edges.reserve(50);
   }
+
+  /**
+   * @brief Number of edges shared with another pair.
+   */
+  int overlapWith(const int other) const {
+    auto it = std::lower_bound(competitors.begin(), competitors.end(),
+                               std::make_pair(other, 0));
+    return (it != competitors.end() && it->first == other) ? it->second : 0;
+  }
+
+  /**
+   * @brief Counts one more edge shared with another pair.
+   */
+  void addOverlap(const int other) {
+    auto it = std::lower_bound(competitors.begin(), competitors.end(),
+                               std::make_pair(other, 0));
+    if (it != competitors.end() && it->first == other)
+      it->second++;
+    else
+      competitors.insert(it, {other, 1});
+  }
+
+  /**
+   * @brief Counts one less edge shared with another pair.
+   * @return false if the pairs did not overlap.
+   */
+  bool removeOverlap(const int other) {
+    auto it = std::lower_bound(competitors.begin(), competitors.end(),
+                               std::make_pair(other, 0));
+    if (it == competitors.end() || it->first != other) return false;
+    if (--it->second == 0) competitors.erase(it);
+    return true;
+  }
   
   bool operator==(const SolutionPair& other) const {
     return (source == other.source && target == other.target) ||
@@ -73,6 +113,29 @@ struct SolutionPair {
   }
 };
   
+/**
+ * @struct PairListPool
+ * @brief Free list of the pair lists of removed edges, so edges inserted
+ * later reuse their capacity. Copies of a solution start with an empty pool.
+ */
+struct PairListPool {
+  std::vector<std::vector<int>> lists;
+
+  PairListPool() = default;
+  PairListPool(const PairListPool&) {}
+  PairListPool(PairListPool&&) = default;
+  PairListPool& operator=(const PairListPool&) { return *this; }
+  PairListPool& operator=(PairListPool&&) = default;
+
+  void give(std::vector<int>&& list) { lists.push_back(std::move(list)); }
+  std::vector<int> take() {
+    if (lists.empty()) return {};
+    std::vector<int> list = std::move(lists.back());
+    lists.pop_back();
+    return list;
+  }
+};
+
 /**
  * @class SFPSolution
  * @brief Mutable state of the SFP.
@@ -83,18 +146,42 @@ class SFPSolution {
  protected:
   const SFPProblem* problem;
   std::vector<int> edges;
-  std::vector<uint8_t> bitmask;
-  std::vector<std::pair<uint8_t, int>> nodes;
+  EdgeMask bitmask;
+  std::vector<std::pair<uint8_t, int>> nodes;  ///< {is terminal, active degree}
+  std::vector<int> hubs;                        ///< Nodes of active degree >= 3, unordered
+  std::vector<int> hubSlot;                     ///< Index in hubs, -1 if not a hub
   double currentCost;
   std::vector<SolutionEdge> active_edges;
   std::vector<SolutionPair> pairs;
+  PairListPool spareLists;
+
+  /// Moves a node in or out of the hub set when its active degree crosses 3
+  void addDegree(const int node_id, const int delta);
 
  public:
   SFPSolution(const SFPProblem* problem, std::vector<SolutionPair> pairs = {});
+
+  /**
+   * @brief Disconnects every pair, keeping the capacity of all the buffers.
+   * Edge states are cleared on the active edges only, so no ditch may be left
+   * set by the caller.
+   */
+  void reset();
+
+  /**
+   * @brief Empty solution of the same problem over new pairs. Buffers are
+   * reused, so restarts do not allocate a new solution each time.
+   */
+  void reinit(const std::vector<SolutionPair>& new_pairs);
   
   bool isTerminal(int node_id) const {return nodes[node_id].first; }
-  bool isEdgeActive(const int edge_id) const {return bitmask[edge_id];};
-  const std::vector<uint8_t>* getBitmask() const { return &bitmask; }
+  int getActiveDegree(const int node_id) const { return nodes[node_id].second; }
+  /// Nodes with 3 active edges or more, kept up to date by insert/erase
+  const std::vector<int>* getHubs() const { return &hubs; }
+  bool isEdgeActive(const int edge_id) const {return bitmask.isBridge(edge_id);};
+  // Per-edge EdgeState: active edges are bridges, ditchs are set by the caller
+  const EdgeMask* getBitmask() const { return &bitmask; }
+  void setDitch(const int edge_id, const bool ditch);
   
   const std::vector<SolutionEdge>* getEdges() const { return &active_edges; }
   int getNEdges() const { return active_edges.size(); }
@@ -111,28 +198,97 @@ class SFPSolution {
   int getNPairs() const { return pairs.size(); }
   const std::vector<int> getCompetingPairs(const int pair_id) const {
     std::vector<int> temp;
-    temp.reserve(16);
-    for (int it = 0; it < (int) pairs.size(); it++)
-      if (pairs[pair_id].competing_pairs_sum[it] > 0) temp.push_back(it);
+    temp.reserve(pairs[pair_id].competitors.size());
+    for (const auto& overlap : pairs[pair_id].competitors) temp.push_back(overlap.first);
     return temp;
   }
   int getIntersectionsSum(const int pair_a, const int pair_b) const {
-    return pairs[pair_a].competing_pairs_sum[pair_b];
+    return pairs[pair_a].overlapWith(pair_b);
   }
 
   double getCurrentCost() const { return currentCost; }
   const SFPProblem* getProblem() const { return problem; }
+  /// Bytes held by the solution, path and pair lists included
+  size_t memoryBytes() const;
   bool isFeasible() const;
 
   int insert(const int edge_id, const int pair_id);
   int erase(const int edge_id, const int pair_id = -1);
 
+  /**
+   * @brief Edges left without pairs if every pair of pair_ids is
+   * disconnected, one id per undirected edge. The solution is not modified.
+   */
+  void releasedEdges(const std::vector<int>& pair_ids, std::vector<int>& released) const;
+
+  /**
+   * @brief Exact cost change of replacing the paths of pair_ids by new_paths
+   * (same order), computed from the edge usage counts. The solution is not
+   * modified, so rejected moves never go through insert/erase.
+   */
+  double evaluateReroute(const std::vector<int>& pair_ids,
+                         const std::vector<std::vector<int>>& new_paths) const;
+
   bool operator>(const SFPSolution& other) const;
   bool operator<(const SFPSolution& other) const;
 
   friend std::ostream& operator<<(std::ostream& out, const SFPSolution& sol);
 };
 
+/**
+ * @struct SFPSnapshot
+ * @brief Flat, copy-cheap record of a solution: its pairs, their paths in a
+ * single array and its cost. Rebuilds a full SFPSolution on demand and
+ * round-trips through a text solution file.
+ * * Solution file format (nodes numbered from 1, as in STP):
+ * SFP SOLUTION 1
+ * Instance <name>
+ * Cost <cost>
+ * Pairs <number of pairs>
+ * P <source> <target> <number of path edges>
+ * E <u> <v>
+ * ...
+ * END
+ */
+struct SFPSnapshot {
+  double cost = std::numeric_limits<double>::infinity();  ///< Infinity until captured
+  std::vector<std::pair<int, int>> pairs;  ///< {source, target} of each pair
+  std::vector<int> pathOffsets;  ///< Pair p owns pathEdges[pathOffsets[p], pathOffsets[p + 1])
+  std::vector<int> pathEdges;    ///< Edge ids, -1 if a loaded edge is not in the graph
+  std::vector<int> edges;        ///< Active edge ids (lower id of each twin)
+
+  bool captured() const { return cost != std::numeric_limits<double>::infinity(); }
+  size_t memoryBytes() const {
+    return sizeof(*this) + vectorBytes(pairs) + vectorBytes(pathOffsets) + vectorBytes(pathEdges) +
+           vectorBytes(edges);
+  }
+
+  /**
+   * @brief Records a solution, reusing the capacity of the arrays.
+   */
+  void capture(const SFPSolution& solution);
+
+  /**
+   * @brief Rebuilds the recorded solution into `solution` (same problem).
+   * @throws std::runtime_error if a path edge is not in the graph.
+   */
+  void restore(SFPSolution& solution) const;
+  SFPSolution toSolution(const SFPProblem* problem) const;
+
+  /**
+   * @brief Writes the solution file (see the format above).
+   */
+  void save(const std::string& path, const SFPProblem& problem) const;
+
+  /**
+   * @brief Reads a solution file. Edges are matched by their endpoints on
+   * the problem graph (the cheapest parallel edge), so the file does not
+   * depend on the CSR layout.
+   * @throws std::runtime_error with the line number on malformed input.
+   */
+  void load(const std::string& path, const SFPProblem& problem);
+};
+
 /**
  * @class SFPProblem
  * @brief Represents the static definition of a Steiner Forest Problem instance.
@@ -145,6 +301,19 @@ class SFPProblem {
   std::vector<std::pair<int, int>> terminals;
   std::string instanceName;
 
+  /**
+   * @brief Parses an in-memory STP buffer (see operator>> for the format).
+   * @throws std::runtime_error with the line number on malformed input.
+   */
+  void parseBuffer(const char* begin, const char* end);
+
+  /**
+   * @brief Loads a binary snapshot written by saveBinary(). The CSR is copied
+   * as is, so the Graph is not rebuilt.
+   * @throws std::runtime_error on version, byte order or size mismatch.
+   */
+  void parseBinary(const char* begin, const char* end);
+
  public:
   explicit SFPProblem(std::shared_ptr<Graph> g,
                       const std::vector<std::pair<int, int>>& terminals);
@@ -162,6 +331,20 @@ class SFPProblem {
   std::string getName() const { return instanceName; }
   void setName(const std::string name) { instanceName = name; }
 
+  /**
+   * @brief Loads an instance through a memory map. Binary snapshots are
+   * recognized by their magic number, anything else is parsed as STP text.
+   * @param path Path of the .stp or .sfpb file.
+   */
+  void loadFile(const std::string& path);
+
+  /**
+   * @brief Writes a versioned binary snapshot (.sfpb) holding the CSR, with
+   * reverse pointers resolved, the total weight and the terminal pairs.
+   * @param path Destination file.
+   */
+  void saveBinary(const std::string& path) const;
+
   // Overloads
   /**
    * @brief Overload of the input operator to parse the specific file format.
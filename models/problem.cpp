@@ -1,3 +1,12 @@
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+
+#include "../utils/MappedFile.hpp"
+#include "../utils/Stats.hpp"
 #include "SFP.hpp"
 
 SFPProblem::SFPProblem(std::shared_ptr<Graph> g,
@@ -10,75 +19,185 @@ SFPProblem::SFPProblem(std::shared_ptr<Graph> g,
     throw std::runtime_error("\tGraph is not connected.");
 }
 
-std::istream& operator>>(std::istream& in, SFPProblem& sf) {
-  std::string token;
+namespace {
+
+/**
+ * @struct STPScanner
+ * @brief Line-oriented cursor over an in-memory STP buffer.
+ * * Words are compared in place and numbers are parsed by hand, so no
+ * std::string is created per token.
+ */
+struct STPScanner {
+  const char* pos;
+  const char* end;
+  int line;
+
+  STPScanner(const char* begin, const char* end) : pos(begin), end(end), line(1) {}
+
+  [[noreturn]] void fail(const std::string& msg) const {
+    throw std::runtime_error("\tLine " + std::to_string(line) + ": " + msg);
+  }
+
+  void skipBlanks() {
+    while (pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\r')) ++pos;
+  }
+
+  /// Skips the rest of the current line, including the line break.
+  void nextLine() {
+    while (pos < end && *pos != '\n') ++pos;
+    if (pos < end) {
+      ++pos;
+      ++line;
+    }
+  }
+
+  bool atLineEnd() {
+    skipBlanks();
+    return pos >= end || *pos == '\n';
+  }
+
+  /// Reads the next word of the line as a [begin, end) view.
+  std::pair<const char*, const char*> word() {
+    skipBlanks();
+    const char* start = pos;
+    while (pos < end && *pos != ' ' && *pos != '\t' && *pos != '\r' && *pos != '\n') ++pos;
+    return {start, pos};
+  }
+
+  static bool equals(const std::pair<const char*, const char*>& w, const char* keyword) {
+    const char* it = w.first;
+    for (; it < w.second && *keyword; ++it, ++keyword)
+      if (*it != *keyword) return false;
+    return it == w.second && *keyword == '\0';
+  }
+
+  static bool contains(const std::pair<const char*, const char*>& w, const char* keyword) {
+    const size_t len = std::strlen(keyword);
+    for (const char* it = w.first; it + len <= w.second; ++it)
+      if (std::equal(keyword, keyword + len, it)) return true;
+    return false;
+  }
+
+  /// Node ids, counts and exponents all end up in an int, so larger values are rejected
+  long long integer(const char* what) {
+    skipBlanks();
+    bool negative = false;
+    if (pos < end && (*pos == '-' || *pos == '+')) negative = (*pos++ == '-');
+    if (pos >= end || *pos < '0' || *pos > '9') fail(std::string("expected an integer ") + what);
+
+    constexpr long long kMax = std::numeric_limits<int>::max();
+    long long value = 0;
+    while (pos < end && *pos >= '0' && *pos <= '9') {
+      value = value * 10 + (*pos++ - '0');
+      if (value > kMax) fail(std::string("integer out of range ") + what);
+    }
+    return negative ? -value : value;
+  }
+
+  double real(const char* what) {
+    skipBlanks();
+    bool negative = false;
+    if (pos < end && (*pos == '-' || *pos == '+')) negative = (*pos++ == '-');
+
+    bool digits = false;
+    double value = 0.0;
+    while (pos < end && *pos >= '0' && *pos <= '9') {
+      value = value * 10.0 + (*pos++ - '0');
+      digits = true;
+    }
+    if (pos < end && *pos == '.') {
+      ++pos;
+      double scale = 0.1;
+      while (pos < end && *pos >= '0' && *pos <= '9') {
+        value += (*pos++ - '0') * scale;
+        scale *= 0.1;
+        digits = true;
+      }
+    }
+    if (!digits) fail(std::string("expected a number ") + what);
+
+    if (pos < end && (*pos == 'e' || *pos == 'E')) {
+      ++pos;
+      value *= std::pow(10.0, static_cast<double>(integer("as exponent")));
+    }
+    return negative ? -value : value;
+  }
+};
+
+}  // namespace
+
+void SFPProblem::parseBuffer(const char* begin, const char* end) {
+  STPScanner scan(begin, end);
   bool readingGraph = false;
   bool readingTerminals = false;
   std::vector<std::tuple<int, int, float>> edgeList;
-  int nNodes = 0;
+  long long nNodes = 0;
 
-  while (in >> token) {
-    if (token == "SECTION") {
-      std::string sectionName;
-      in >> sectionName;
+  auto node = [&](const char* what) {
+    long long id = scan.integer(what);
+    if (id < 1 || (nNodes > 0 && id > nNodes))
+      scan.fail("node " + std::to_string(id) + " out of range " + what);
+    return static_cast<int>(id - 1);
+  };
 
-      if (sectionName.find("Graph") != std::string::npos) {
-        readingGraph = true;
-        readingTerminals = false;
-      }
+  for (; scan.pos < scan.end; scan.nextLine()) {
+    auto token = scan.word();
+    if (token.first == token.second) continue;
 
-      else if (sectionName.find("Terminals") != std::string::npos) {
-        readingGraph = false;
-        readingTerminals = true;
-      }
+    if (STPScanner::equals(token, "SECTION")) {
+      auto sectionName = scan.word();
+      readingGraph = STPScanner::contains(sectionName, "Graph");
+      readingTerminals = !readingGraph && STPScanner::contains(sectionName, "Terminals");
     }
 
-    else if (token == "END") {
+    else if (STPScanner::equals(token, "END")) {
       readingGraph = false;
       readingTerminals = false;
     }
 
     else if (readingGraph) {
-      if (token == "Nodes")
-        in >> nNodes;
+      if (STPScanner::equals(token, "Nodes"))
+        nNodes = scan.integer("after Nodes");
 
-      else if (token == "Edges") {
-        int nEdges;
-        in >> nEdges;
+      else if (STPScanner::equals(token, "Edges")) {
+        long long nEdges = scan.integer("after Edges");
+        if (nEdges < 0) scan.fail("negative number of edges");
         edgeList.reserve(nEdges);
       }
 
-      else if (token == "E") {
-        int source, target;
-        float weight;
-        in >> source >> target >> weight;
-        edgeList.push_back({source - 1, target - 1, weight});
+      else if (STPScanner::equals(token, "E")) {
+        int source = node("as edge source");
+        int target = node("as edge target");
+        float weight = static_cast<float>(scan.real("as edge weight"));
+        if (!scan.atLineEnd()) scan.fail("unexpected data after edge");
+        edgeList.emplace_back(source, target, weight);
       }
     }
 
     else if (readingTerminals) {
-      if (token == "Terminals") {
-        int nTerminals;
-        in >> nTerminals;
-        sf.terminals.reserve(nTerminals);
+      if (STPScanner::equals(token, "Terminals")) {
+        long long nTerminals = scan.integer("after Terminals");
+        if (nTerminals < 0) scan.fail("negative number of terminals");
+        terminals.reserve(nTerminals);
       } 
-      else if (token == "TP") {
-        int source, target;
-        in >> source >> target;
-        sf.terminals.push_back({source - 1, target - 1});
+      else if (STPScanner::equals(token, "TP")) {
+        int source = node("as terminal");
+        int target = node("as terminal");
+        if (!scan.atLineEnd()) scan.fail("unexpected data after terminal pair");
+        terminals.push_back({source, target});
       }
     }
   }
 
   if (nNodes > 0 && !edgeList.empty()) {
     try {
-      sf.graph = std::make_shared<Graph>(edgeList, nNodes);
+      graph = std::make_shared<Graph>(edgeList, static_cast<int>(nNodes));
 
-      if (hasNegativeWeights(*sf.graph)) {
+      if (hasNegativeWeights(*graph)) {
         throw std::runtime_error("\tGraph has negative weights.");
       }
 
-      if (!isGraphConnected(*sf.graph)) {
+      if (!isGraphConnected(*graph)) {
         throw std::runtime_error("\tGraph is disconnected.");
       }
 
@@ -91,7 +210,128 @@ std::istream& operator>>(std::istream& in, SFPProblem& sf) {
 
   else
     throw std::runtime_error("\tInvalid or empty STP file structure.");
-  
+}
+
+namespace {
+
+constexpr char kBinaryMagic[4] = {'S', 'F', 'P', 'B'};
+constexpr uint32_t kBinaryVersion = 1;
+constexpr uint32_t kByteOrderMark = 0x01020304;
+
+/**
+ * @struct BinaryHeader
+ * @brief Fixed header of the binary instance snapshot (.sfpb).
+ * * Followed by ptrs[nNodes + 1], edges[nEdges] and terminals[nTerminals],
+ * all in native byte order.
+ */
+struct BinaryHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t byteOrder;
+  int32_t nNodes;
+  int32_t nEdges;
+  int32_t nTerminals;
+  float totalWeight;
+  uint32_t reserved;
+};
+
+static_assert(sizeof(Edge) == 16, "Binary snapshots assume a packed 16-byte Edge.");
+
+}  // namespace
+
+void SFPProblem::parseBinary(const char* begin, const char* end) {
+  const size_t size = end - begin;
+  BinaryHeader header;
+  if (size < sizeof(header)) throw std::runtime_error("\tTruncated binary instance header.");
+  std::memcpy(&header, begin, sizeof(header));
+
+  if (header.version != kBinaryVersion)
+    throw std::runtime_error("\tUnsupported binary instance version " + std::to_string(header.version) +
+                             " (expected " + std::to_string(kBinaryVersion) + ").");
+  if (header.byteOrder != kByteOrderMark)
+    throw std::runtime_error("\tBinary instance was written with a different byte order.");
+  if (header.nNodes <= 0 || header.nEdges <= 0 || header.nTerminals < 0)
+    throw std::runtime_error("\tInvalid binary instance sizes.");
+
+  const size_t ptrsBytes = (static_cast<size_t>(header.nNodes) + 1) * sizeof(int);
+  const size_t edgesBytes = static_cast<size_t>(header.nEdges) * sizeof(Edge);
+  const size_t termsBytes = static_cast<size_t>(header.nTerminals) * 2 * sizeof(int32_t);
+  if (size != sizeof(header) + ptrsBytes + edgesBytes + termsBytes)
+    throw std::runtime_error("\tBinary instance size does not match its header.");
+
+  const char* cursor = begin + sizeof(header);
+  std::vector<int> ptrs(header.nNodes + 1);
+  std::memcpy(ptrs.data(), cursor, ptrsBytes);
+  cursor += ptrsBytes;
+
+  std::vector<Edge> edges(header.nEdges);
+  std::memcpy(edges.data(), cursor, edgesBytes);
+  cursor += edgesBytes;
+
+  std::vector<int32_t> rawTerminals(2 * static_cast<size_t>(header.nTerminals));
+  std::memcpy(rawTerminals.data(), cursor, termsBytes);
+
+  terminals.clear();
+  terminals.reserve(header.nTerminals);
+  for (int i = 0; i < header.nTerminals; ++i) {
+    int u = rawTerminals[2 * i], v = rawTerminals[2 * i + 1];
+    if (u < 0 || u >= header.nNodes || v < 0 || v >= header.nNodes)
+      throw std::runtime_error("\tBinary instance terminal out of range.");
+    terminals.push_back({u, v});
+  }
+
+  try {
+    graph = std::make_shared<Graph>(std::move(ptrs), std::move(edges), header.totalWeight);
+    if (hasNegativeWeights(*graph)) throw std::runtime_error("\tGraph has negative weights.");
+    if (!isGraphConnected(*graph)) throw std::runtime_error("\tGraph is disconnected.");
+  } catch (const std::exception& e) {
+    throw std::runtime_error("\tError constructing graph\n" + std::string(e.what()));
+  }
+}
+
+void SFPProblem::saveBinary(const std::string& path) const {
+  if (!graph) throw std::runtime_error("\tCannot save an empty instance.");
+
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (!out.is_open()) throw std::runtime_error("\tThe file cannot be created: " + path);
+
+  BinaryHeader header;
+  std::memcpy(header.magic, kBinaryMagic, sizeof(kBinaryMagic));
+  header.version = kBinaryVersion;
+  header.byteOrder = kByteOrderMark;
+  header.nNodes = graph->nNodes;
+  header.nEdges = graph->nEdges;
+  header.nTerminals = static_cast<int32_t>(terminals.size());
+  header.totalWeight = graph->totalWeight;
+  header.reserved = 0;
+
+  std::vector<int32_t> rawTerminals;
+  rawTerminals.reserve(2 * terminals.size());
+  for (const auto& t : terminals) {
+    rawTerminals.push_back(t.first);
+    rawTerminals.push_back(t.second);
+  }
+
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  out.write(reinterpret_cast<const char*>(graph->ptrs.data()), graph->ptrs.size() * sizeof(int));
+  out.write(reinterpret_cast<const char*>(graph->edges.data()), graph->edges.size() * sizeof(Edge));
+  out.write(reinterpret_cast<const char*>(rawTerminals.data()), rawTerminals.size() * sizeof(int32_t));
+  if (!out) throw std::runtime_error("\tError writing binary instance: " + path);
+}
+
+void SFPProblem::loadFile(const std::string& path) {
+  SFP_STAT_TIMER(PARSE);
+  MappedFile file(path);
+  if (file.size() >= sizeof(kBinaryMagic) &&
+      std::memcmp(file.begin(), kBinaryMagic, sizeof(kBinaryMagic)) == 0)
+    parseBinary(file.begin(), file.end());
+  else
+    parseBuffer(file.begin(), file.end());
+}
+
+std::istream& operator>>(std::istream& in, SFPProblem& sf) {
+  std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  sf.parseBuffer(content.data(), content.data() + content.size());
   return in;
 }
 
@@ -0,0 +1,299 @@
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <unordered_map>
+
+#include "Reduction.hpp"
+
+namespace {
+
+/// Nodes a long-edge search may settle, and edges it may scan, before
+/// giving up on the edge (dense graphs would otherwise cost a full search
+/// per edge for nothing)
+constexpr int kLongEdgeSettled = 64;
+constexpr int kLongEdgeScans = 64;
+
+/// Rounds of the reduction loop at most, each one usually removes far less than the first
+constexpr int kMaxRounds = 4;
+
+/**
+ * @struct WorkEdge
+ * @brief Undirected edge of the graph being reduced.
+ */
+struct WorkEdge {
+  int u, v;
+  float weight;
+  std::vector<int> path;  ///< Original directed edges from u to v
+  bool alive;
+};
+
+/**
+ * @class WorkGraph
+ * @brief Mutable adjacency lists where edges die lazily.
+ */
+class WorkGraph {
+ public:
+  const Graph& graph;
+  std::vector<WorkEdge> edges;
+  std::vector<std::vector<int>> adj;  ///< Incident edge ids, dead ones included
+  std::vector<int> degree;            ///< Alive incident edges
+  std::vector<bool> isTerminal;
+
+  // Bounded Dijkstra scratch
+  std::vector<float> dist;
+  std::vector<unsigned int> seen;
+  unsigned int token = 0;
+
+  WorkGraph(const SFPProblem& problem)
+      : graph(*problem.getGraphPtr()),
+        adj(graph.nNodes),
+        degree(graph.nNodes, 0),
+        isTerminal(graph.nNodes, false),
+        dist(graph.nNodes),
+        seen(graph.nNodes, 0) {
+    for (const auto& [s, t] : problem.getTerminals()) isTerminal[s] = isTerminal[t] = true;
+
+    // Parallel edges: only the cheapest one stays
+    std::unordered_map<long long, int> byEnds;
+    for (int i = 0; i < graph.nEdges; ++i) {
+      if (graph.rev[i] != -1 && graph.rev[i] < i) continue;
+      int u = graph.edges[i].source, v = graph.edges[i].target;
+      long long key = static_cast<long long>(std::min(u, v)) * graph.nNodes + std::max(u, v);
+      auto [it, added] = byEnds.try_emplace(key, edges.size());
+      if (!added) {
+        if (graph.weights[i] < edges[it->second].weight)
+          edges[it->second] = {u, v, graph.weights[i], {i}, true};
+        continue;
+      }
+      add(u, v, graph.weights[i], {i});
+    }
+  }
+
+  int add(const int u, const int v, const float weight, std::vector<int> path) {
+    int id = edges.size();
+    edges.push_back({u, v, weight, std::move(path), true});
+    adj[u].push_back(id);
+    degree[u]++;
+    if (v != u) {
+      adj[v].push_back(id);
+      degree[v]++;
+    }
+    return id;
+  }
+
+  void kill(const int id) {
+    WorkEdge& e = edges[id];
+    e.alive = false;
+    degree[e.u]--;
+    if (e.v != e.u) degree[e.v]--;
+  }
+
+  int other(const int id, const int node) const {
+    return edges[id].u == node ? edges[id].v : edges[id].u;
+  }
+
+  /// Path of an edge read from `from` to its other end
+  std::vector<int> pathFrom(const int id, const int from) const {
+    const WorkEdge& e = edges[id];
+    if (e.u == from) return e.path;
+    std::vector<int> reversed;
+    reversed.reserve(e.path.size());
+    for (auto it = e.path.rbegin(); it != e.path.rend(); ++it) reversed.push_back(graph.rev[*it]);
+    return reversed;
+  }
+
+  /**
+   * @brief Whether another path from u to v costs at most the weight of the
+   * edge. The search is bounded (kLongEdgeSettled, kLongEdgeScans), so a
+   * failure only means "not found".
+   */
+  bool hasAlternative(const int id) {
+    const WorkEdge& e = edges[id];
+    if (e.u == e.v) return true;
+
+    // Another path leaves u and enters v by other edges
+    auto cheapestOther = [&](const int x) {
+      for (int f : adj[x])
+        if (f != id && edges[f].alive) return edges[f].weight;
+      return std::numeric_limits<float>::infinity();
+    };
+    if (cheapestOther(e.u) + cheapestOther(e.v) > e.weight) return false;
+
+    token++;
+    using Item = std::pair<float, int>;
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> pq;
+    dist[e.u] = 0.0f;
+    seen[e.u] = token;
+    pq.push({0.0f, e.u});
+
+    int settled = 0, scans = 0;
+    while (!pq.empty() && settled < kLongEdgeSettled && scans < kLongEdgeScans) {
+      auto [d, x] = pq.top();
+      pq.pop();
+      if (d > dist[x]) continue;
+      if (x == e.v) return true;
+      settled++;
+
+      // Lists are sorted by weight: the rest of the row is too long
+      for (int f : adj[x]) {
+        if (f == id || !edges[f].alive) continue;
+        float nd = d + edges[f].weight;
+        if (nd > e.weight) break;
+        scans++;
+        int y = other(f, x);
+        if (seen[y] != token || nd < dist[y]) {
+          seen[y] = token;
+          dist[y] = nd;
+          pq.push({nd, y});
+        }
+      }
+    }
+    return false;
+  }
+
+  /// Sorts every list by weight and drops the dead edges
+  void compact() {
+    for (auto& list : adj) {
+      list.erase(std::remove_if(list.begin(), list.end(), [&](int f) { return !edges[f].alive; }),
+                 list.end());
+      std::sort(list.begin(), list.end(), [&](int a, int b) {
+        return edges[a].weight != edges[b].weight ? edges[a].weight < edges[b].weight : a < b;
+      });
+    }
+  }
+
+  int findAlive(const int a, const int b) const {
+    const int from = adj[a].size() <= adj[b].size() ? a : b;
+    const int to = from == a ? b : a;
+    for (int f : adj[from])
+      if (edges[f].alive && other(f, from) == to) return f;
+    return -1;
+  }
+};
+
+}  // namespace
+
+SFPReduction::SFPReduction(const SFPProblem& problem) : original(&problem) {
+  WorkGraph work(problem);
+  const int nNodes = problem.getNNodes();
+  stats.nodesBefore = nNodes;
+  stats.edgesBefore = problem.getNEdges() / 2;
+
+  std::deque<int> queue;
+  std::vector<bool> queued(nNodes, false);
+  auto push = [&](const int x) {
+    if (work.isTerminal[x] || queued[x] || work.degree[x] > 2) return;
+    queued[x] = true;
+    queue.push_back(x);
+  };
+
+  for (int round = 0; round < kMaxRounds; ++round) {
+    int removed = 0;
+
+    // Long-edge test, on the graph as it shrinks
+    work.compact();
+    for (int id = 0; id < static_cast<int>(work.edges.size()); ++id)
+      if (work.edges[id].alive && work.hasAlternative(id)) {
+        work.kill(id);
+        stats.longEdges++;
+        removed++;
+      }
+
+    // Non-terminal leaves and degree-2 nodes
+    for (int x = 0; x < nNodes; ++x) push(x);
+    while (!queue.empty()) {
+      int x = queue.front();
+      queue.pop_front();
+      queued[x] = false;
+      if (work.degree[x] == 0 || work.degree[x] > 2) continue;
+
+      std::vector<int> incident;
+      for (int f : work.adj[x])
+        if (work.edges[f].alive) incident.push_back(f);
+
+      if (incident.size() == 1) {
+        int y = work.other(incident[0], x);
+        work.kill(incident[0]);
+        stats.leaves++;
+        removed++;
+        push(y);
+        continue;
+      }
+
+      int a = work.other(incident[0], x), b = work.other(incident[1], x);
+      float weight = work.edges[incident[0]].weight + work.edges[incident[1]].weight;
+      std::vector<int> path = work.pathFrom(incident[0], a);
+      std::vector<int> second = work.pathFrom(incident[1], x);
+      path.insert(path.end(), second.begin(), second.end());
+
+      work.kill(incident[0]);
+      work.kill(incident[1]);
+      stats.contracted++;
+      removed++;
+
+      // a - x - a never helps; an existing a - b edge is kept if not longer
+      if (a != b) {
+        int existing = work.findAlive(a, b);
+        if (existing == -1 || work.edges[existing].weight > weight) {
+          if (existing != -1) work.kill(existing);
+          work.add(a, b, weight, std::move(path));
+        }
+      }
+      push(a);
+      push(b);
+    }
+
+    if (removed == 0) break;
+  }
+
+  // Renumber the nodes that are still used
+  std::vector<int> reducedNode(nNodes, -1);
+  for (int x = 0; x < nNodes; ++x)
+    if (work.isTerminal[x] || work.degree[x] > 0) {
+      reducedNode[x] = originalNode.size();
+      originalNode.push_back(x);
+    }
+
+  std::vector<std::tuple<int, int, float>> edgeList;
+  std::vector<int> kept;
+  for (int id = 0; id < static_cast<int>(work.edges.size()); ++id)
+    if (work.edges[id].alive) {
+      const WorkEdge& e = work.edges[id];
+      edgeList.push_back({reducedNode[e.u], reducedNode[e.v], e.weight});
+      kept.push_back(id);
+    }
+
+  std::vector<std::pair<int, int>> terminals;
+  for (const auto& [s, t] : problem.getTerminals()) terminals.push_back({reducedNode[s], reducedNode[t]});
+
+  auto graph = std::make_shared<Graph>(edgeList, originalNode.size());
+  originalPath.assign(graph->nEdges, {});
+  for (size_t k = 0; k < kept.size(); ++k) {
+    const WorkEdge& e = work.edges[kept[k]];
+    int id = graph->findEdge(reducedNode[e.u], reducedNode[e.v]);
+    originalPath[id] = e.path;
+    originalPath[graph->rev[id]] = work.pathFrom(kept[k], e.v);
+  }
+
+  reduced = SFPProblem(graph, terminals);
+  reduced.setName(problem.getName());
+  stats.nodesAfter = graph->nNodes;
+  stats.edgesAfter = edgeList.size();
+}
+
+SFPSolution SFPReduction::expand(const SFPSolution& solution) const {
+  std::vector<SolutionPair> pairs;
+  pairs.reserve(solution.getNPairs());
+  for (int p = 0; p < solution.getNPairs(); ++p) {
+    auto [s, t] = solution.getPairNodes(p);
+    pairs.emplace_back(originalNode[s], originalNode[t]);
+  }
+
+  SFPSolution expanded(original, pairs);
+  for (int p = 0; p < solution.getNPairs(); ++p)
+    for (int edge_id : *solution.getPairEdges(p))
+      for (int original_id : originalPath[edge_id]) expanded.insert(original_id, p);
+  return expanded;
+}
@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include "SFP.hpp"
+
+void SFPSnapshot::capture(const SFPSolution& solution) {
+  cost = solution.getCurrentCost();
+
+  pairs.clear();
+  pathOffsets.clear();
+  pathEdges.clear();
+  for (int p = 0; p < solution.getNPairs(); ++p) {
+    pairs.push_back(solution.getPairNodes(p));
+    pathOffsets.push_back(pathEdges.size());
+    const auto* path = solution.getPairEdges(p);
+    pathEdges.insert(pathEdges.end(), path->begin(), path->end());
+  }
+  pathOffsets.push_back(pathEdges.size());
+
+  edges.clear();
+  for (const auto& edge : *solution.getEdges()) edges.push_back(edge.id);
+}
+
+void SFPSnapshot::restore(SFPSolution& solution) const {
+  std::vector<SolutionPair> solutionPairs;
+  solutionPairs.reserve(pairs.size());
+  for (const auto& [source, target] : pairs) solutionPairs.emplace_back(source, target);
+  solution.reinit(solutionPairs);
+
+  for (size_t p = 0; p < pairs.size(); ++p)
+    for (int k = pathOffsets[p]; k < pathOffsets[p + 1]; ++k)
+      if (!solution.insert(pathEdges[k], p))
+        throw std::runtime_error("\tThe snapshot path of pair " + std::to_string(p) +
+                                 " is not in the graph.");
+}
+
+SFPSolution SFPSnapshot::toSolution(const SFPProblem* problem) const {
+  SFPSolution solution = problem->empty_solution();
+  restore(solution);
+  return solution;
+}
+
+void SFPSnapshot::save(const std::string& path, const SFPProblem& problem) const {
+  std::ofstream out(path);
+  if (!out.is_open()) throw std::runtime_error("\tThe file cannot be created: " + path);
+
+  const auto& graphEdges = problem.getGraphPtr()->edges;
+  out << "SFP SOLUTION 1\n";
+  out << "Instance " << problem.getName() << "\n";
+  out << "Cost " << std::setprecision(17) << cost << "\n";
+  out << "Pairs " << pairs.size() << "\n";
+  for (size_t p = 0; p < pairs.size(); ++p) {
+    out << "P " << pairs[p].first + 1 << " " << pairs[p].second + 1 << " "
+        << pathOffsets[p + 1] - pathOffsets[p] << "\n";
+    for (int k = pathOffsets[p]; k < pathOffsets[p + 1]; ++k) {
+      const Edge& edge = graphEdges[pathEdges[k]];
+      out << "E " << edge.source + 1 << " " << edge.target + 1 << "\n";
+    }
+  }
+  out << "END\n";
+
+  if (!out) throw std::runtime_error("\tError writing solution: " + path);
+}
+
+void SFPSnapshot::load(const std::string& path, const SFPProblem& problem) {
+  std::ifstream in(path);
+  if (!in.is_open()) throw std::runtime_error("\tThe file cannot be opened: " + path);
+
+  const Graph& graph = *problem.getGraphPtr();
+  int lineNumber = 0;
+  std::string line, token;
+  auto fail = [&](const std::string& msg) {
+    throw std::runtime_error("\tLine " + std::to_string(lineNumber) + ": " + msg);
+  };
+  auto next = [&](std::istringstream& fields) {
+    while (std::getline(in, line)) {
+      lineNumber++;
+      fields.clear();
+      fields.str(line);
+      if (fields >> token) return;
+    }
+    lineNumber++;
+    fail("unexpected end of file");
+  };
+  auto node = [&](std::istringstream& fields) {
+    long long id;
+    if (!(fields >> id) || id < 1 || id > graph.nNodes) fail("node out of range");
+    return static_cast<int>(id - 1);
+  };
+
+  std::istringstream fields;
+  next(fields);
+  int version = 0;
+  if (token != "SFP" || !(fields >> token) || token != "SOLUTION" || !(fields >> version))
+    fail("not an SFP solution file");
+  if (version != 1) fail("unsupported solution version " + std::to_string(version));
+
+  double recordedCost = 0.0;
+  long long nPairs = -1;
+  for (next(fields); token != "P" && token != "END"; next(fields)) {
+    if (token == "Cost" && !(fields >> recordedCost)) fail("expected a number after Cost");
+    if (token == "Pairs" && (!(fields >> nPairs) || nPairs < 0)) fail("expected a count after Pairs");
+  }
+  if (nPairs < 0) fail("missing Pairs");
+
+  pairs.clear();
+  pathOffsets.clear();
+  pathEdges.clear();
+  for (long long p = 0; p < nPairs; ++p) {
+    if (token != "P") fail("expected a pair");
+    int source = node(fields), target = node(fields);
+    long long nEdges;
+    if (!(fields >> nEdges) || nEdges < 0) fail("expected the number of path edges");
+    pairs.push_back({std::min(source, target), std::max(source, target)});
+    pathOffsets.push_back(pathEdges.size());
+
+    for (long long k = 0; k < nEdges; ++k) {
+      next(fields);
+      if (token != "E") fail("expected a path edge");
+      int u = node(fields), v = node(fields);
+      pathEdges.push_back(graph.findEdge(u, v));
+    }
+    next(fields);
+  }
+  pathOffsets.push_back(pathEdges.size());
+  if (token != "END") fail("expected END");
+
+  // Active edges of the recorded paths, one id per twin
+  edges.clear();
+  for (int e : pathEdges)
+    if (e != -1) edges.push_back(graph.rev[e] == -1 ? e : std::min(e, graph.rev[e]));
+  std::sort(edges.begin(), edges.end());
+  edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+  // The recorded cost is informative, the weights of this graph prevail
+  cost = 0.0;
+  for (int e : edges) cost += graph.weights[e];
+}
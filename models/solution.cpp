@@ -1,12 +1,14 @@
 #include "../utils/DSU.hpp"
+#include "../utils/Stats.hpp"
 #include "SFP.hpp"
 
 SFPSolution::SFPSolution(const SFPProblem* problem,
                          std::vector<SolutionPair> init_pairs)
     : problem(problem),
       edges(std::vector<int>(problem->getNEdges(), -1)),
-      bitmask(std::vector<uint8_t>(problem->getNEdges(), 0)),
-      nodes(std::vector<std::pair<uint8_t, int>>(problem->getNNodes(), {0, -1})),
+      bitmask(problem->getNEdges()),
+      nodes(std::vector<std::pair<uint8_t, int>>(problem->getNNodes(), {0, 0})),
+      hubSlot(problem->getNNodes(), -1),
       currentCost(0.0f) {
   
   active_edges.reserve(problem->getNNodes());
@@ -20,7 +22,7 @@ SFPSolution::SFPSolution(const SFPProblem* problem,
     }
   } else {
     for (const auto& p : problem->getTerminals()) {
-      pairs.push_back({p.first, p.second, problem->getNTerminals()});
+      pairs.push_back({p.first, p.second});
       nodes[p.first].first = 1;
       nodes[p.second].first = 1;
     }
@@ -28,9 +30,48 @@ SFPSolution::SFPSolution(const SFPProblem* problem,
 }
 
 
+void SFPSolution::reset() {
+  const auto& graphEdges = problem->getGraphPtr()->edges;
+  for (auto& edge : active_edges) {
+    nodes[graphEdges[edge.id].source].second = 0;
+    nodes[graphEdges[edge.id].target].second = 0;
+    edges[edge.id] = -1;
+    if (edge.reverse_id != -1) edges[edge.reverse_id] = -1;
+    bitmask.set(edge.id, edge.reverse_id, EDGE_FREE);
+    spareLists.give(std::move(edge.pairs));
+  }
+  active_edges.clear();
+  for (int hub : hubs) hubSlot[hub] = -1;
+  hubs.clear();
+  currentCost = 0.0;
+
+  for (auto& pair : pairs) {
+    pair.edges.clear();
+    pair.competitors.clear();
+    pair.pathCost = 0.0;
+    pair.synergy = 0;
+  }
+}
+
+void SFPSolution::reinit(const std::vector<SolutionPair>& new_pairs) {
+  reset();
+
+  for (const auto& p : pairs) nodes[p.source].first = nodes[p.target].first = 0;
+  pairs.resize(new_pairs.size(), SolutionPair(0, 0));
+  for (size_t i = 0; i < new_pairs.size(); ++i) {
+    pairs[i].source = new_pairs[i].source;
+    pairs[i].target = new_pairs[i].target;
+    nodes[pairs[i].source].first = 1;
+    nodes[pairs[i].target].first = 1;
+  }
+}
+
 bool SFPSolution::isFeasible() const {
   const auto& graph = problem->getGraphPtr();
-  DSU dsu(graph->nNodes);
+  // Per-thread sets, reset in O(1): the check costs O(active edges + pairs)
+  thread_local SparseDSU dsu;
+  dsu.resize(graph->nNodes);
+  dsu.reset();
   const auto& graphEdges = graph->edges;
 
   for (const auto& i : active_edges) {
@@ -45,6 +86,7 @@ bool SFPSolution::isFeasible() const {
 }
 
 int SFPSolution::insert(const int edge_id, const int pair_id) {
+  SFP_STAT_INC(SOLUTION_INSERTS);
   if (edge_id < 0 || edge_id >= problem->getNEdges()) return 0;
   if (pair_id < 0 || pair_id >= (int)pairs.size()) return 0;
 
@@ -55,14 +97,13 @@ int SFPSolution::insert(const int edge_id, const int pair_id) {
 
   if (active_idx == -1) {
     active_idx = active_edges.size();
-    active_edges.emplace_back(edge_id, reverse_id, graph_edge.weight);
+    active_edges.emplace_back(edge_id, reverse_id, graph_edge.weight, spareLists.take());
     
     edges[edge_id] = active_idx;
-    bitmask[edge_id] = 1;
-    if (reverse_id != -1) {
-      edges[reverse_id] = active_idx;
-      bitmask[reverse_id] = active_idx;
-    }
+    if (reverse_id != -1) edges[reverse_id] = active_idx;
+    bitmask.setBridge(edge_id, reverse_id, true);
+    addDegree(graph_edge.source, 1);
+    addDegree(graph_edge.target, 1);
 
     currentCost += graph_edge.weight;
   }
@@ -76,9 +117,9 @@ int SFPSolution::insert(const int edge_id, const int pair_id) {
     auto& edge_pairs = active_edges[active_idx].pairs;
 
     for (int otrPair : edge_pairs) {
-      pairs[pair_id].competing_pairs_sum[otrPair]++;
+      pairs[pair_id].addOverlap(otrPair);
       pairs[pair_id].synergy++;
-      pairs[otrPair].competing_pairs_sum[pair_id]++;
+      pairs[otrPair].addOverlap(pair_id);
       pairs[otrPair].synergy++;
     }
 
@@ -89,6 +130,7 @@ int SFPSolution::insert(const int edge_id, const int pair_id) {
 }
 
 int SFPSolution::erase(const int edge_id, const int pair_id) {
+  SFP_STAT_INC(SOLUTION_ERASES);
   if (edge_id < 0 || edge_id >= problem->getNEdges()) return 0;
   if (pair_id < 0 || pair_id >= (int)pairs.size()) return 0;
 
@@ -108,10 +150,9 @@ int SFPSolution::erase(const int edge_id, const int pair_id) {
     pairs[pair_id].pathCost -= edge_obj.weight;
 
     for (int otrPair : edge_pairs) {
-      if (otrPair != pair_id && pairs[pair_id].competing_pairs_sum[otrPair] > 0) {
-        pairs[pair_id].competing_pairs_sum[otrPair]--;
+      if (otrPair != pair_id && pairs[pair_id].removeOverlap(otrPair)) {
         pairs[pair_id].synergy--;
-        pairs[otrPair].competing_pairs_sum[pair_id]--;
+        pairs[otrPair].removeOverlap(pair_id);
         pairs[otrPair].synergy--;
       }
     }
@@ -124,11 +165,12 @@ int SFPSolution::erase(const int edge_id, const int pair_id) {
 
     if (edge_pairs.empty()) {
       currentCost -= edge_obj.weight;
+      spareLists.give(std::move(edge_pairs));
 
       int last_idx = active_edges.size() - 1;
       
       if (active_idx != last_idx) {
-        active_edges[active_idx] = active_edges.back();
+        active_edges[active_idx] = std::move(active_edges.back());
         
         edges[active_edges[active_idx].id] = active_idx;
         if (active_edges[active_idx].reverse_id != -1) {
@@ -137,19 +179,123 @@ int SFPSolution::erase(const int edge_id, const int pair_id) {
       }
       active_edges.pop_back();
 
-      auto reverse_id = problem->getGraphPtr()->edges[edge_id].reverseEdgePtr;
+      const auto& graph_edge = problem->getGraphPtr()->edges[edge_id];
+      auto reverse_id = graph_edge.reverseEdgePtr;
+      addDegree(graph_edge.source, -1);
+      addDegree(graph_edge.target, -1);
       edges[edge_id] = -1;
-      bitmask[edge_id] = 0;
-      if (reverse_id != -1) {
-        edges[reverse_id] = -1;
-        bitmask[reverse_id] = 0;
-      }
+      if (reverse_id != -1) edges[reverse_id] = -1;
+      bitmask.setBridge(edge_id, reverse_id, false);
     }
     return 1;
   }
   return 0;
 }
 
+void SFPSolution::addDegree(const int node_id, const int delta) {
+  int& degree = nodes[node_id].second;
+  const bool wasHub = degree >= 3;
+  degree += delta;
+  if (wasHub == (degree >= 3)) return;
+
+  if (!wasHub) {
+    hubSlot[node_id] = hubs.size();
+    hubs.push_back(node_id);
+    return;
+  }
+  const int slot = hubSlot[node_id];
+  hubs[slot] = hubs.back();
+  hubSlot[hubs[slot]] = slot;
+  hubs.pop_back();
+  hubSlot[node_id] = -1;
+}
+
+size_t SFPSolution::memoryBytes() const {
+  size_t bytes = sizeof(*this) + vectorBytes(edges) + bitmask.memoryBytes() + vectorBytes(nodes) +
+                 vectorBytes(hubs) + vectorBytes(hubSlot) + vectorBytes(active_edges) + vectorBytes(pairs) +
+                 vectorBytes(spareLists.lists);
+  for (const auto& edge : active_edges) bytes += vectorBytes(edge.pairs);
+  for (const auto& pair : pairs) bytes += vectorBytes(pair.edges) + vectorBytes(pair.competitors);
+  for (const auto& list : spareLists.lists) bytes += vectorBytes(list);
+  return bytes;
+}
+
+void SFPSolution::setDitch(const int edge_id, const bool ditch) {
+  auto reverse_id = problem->getGraphPtr()->rev[edge_id];
+
+  bitmask.setDitch(edge_id, reverse_id, ditch);
+}
+
+namespace {
+
+// Per-thread counters indexed by active edge slot, zero between calls
+std::vector<int>& slotScratch(const size_t size) {
+  thread_local std::vector<int> scratch;
+  if (scratch.size() < size) scratch.resize(size, 0);
+  return scratch;
+}
+
+}  // namespace
+
+void SFPSolution::releasedEdges(const std::vector<int>& pair_ids,
+                                std::vector<int>& released) const {
+  released.clear();
+  auto& usage = slotScratch(active_edges.size());
+
+  for (int pair_id : pair_ids)
+    for (int edge_id : pairs[pair_id].edges) usage[edges[edge_id]]++;
+
+  for (int pair_id : pair_ids)
+    for (int edge_id : pairs[pair_id].edges) {
+      int& count = usage[edges[edge_id]];
+      if (count == static_cast<int>(active_edges[edges[edge_id]].pairs.size()))
+        released.push_back(active_edges[edges[edge_id]].id);
+      count = 0;
+    }
+}
+
+double SFPSolution::evaluateReroute(const std::vector<int>& pair_ids,
+                                    const std::vector<std::vector<int>>& new_paths) const {
+  const auto& graph = *problem->getGraphPtr();
+  auto& usage = slotScratch(active_edges.size());
+  double delta = 0.0;
+
+  // Old paths: -1 marks the slots that lose all their pairs
+  for (int pair_id : pair_ids)
+    for (int edge_id : pairs[pair_id].edges) usage[edges[edge_id]]++;
+  for (int pair_id : pair_ids)
+    for (int edge_id : pairs[pair_id].edges) {
+      int& count = usage[edges[edge_id]];
+      if (count == static_cast<int>(active_edges[edges[edge_id]].pairs.size())) {
+        delta -= active_edges[edges[edge_id]].weight;
+        count = -1;
+      } else if (count > 0) {
+        count = 0;
+      }
+    }
+
+  // New paths: pay once for every edge not kept by another pair
+  thread_local std::vector<uint8_t> added;
+  if (added.size() < edges.size()) added.resize(edges.size(), 0);
+  auto canonical = [&](const int e) { return graph.rev[e] == -1 ? e : std::min(e, graph.rev[e]); };
+
+  for (const auto& path : new_paths)
+    for (int edge_id : path) {
+      int slot = edges[edge_id];
+      if (slot != -1 && usage[slot] != -1) continue;
+      uint8_t& mark = added[canonical(edge_id)];
+      if (mark) continue;
+      mark = 1;
+      delta += graph.weights[edge_id];
+    }
+
+  for (const auto& path : new_paths)
+    for (int edge_id : path) added[canonical(edge_id)] = 0;
+  for (int pair_id : pair_ids)
+    for (int edge_id : pairs[pair_id].edges) usage[edges[edge_id]] = 0;
+  return delta;
+}
+
 std::ostream& operator<<(std::ostream& out, const SFPSolution& sol) {
   out << std::endl
       << "-------------------------------------------------------------------"
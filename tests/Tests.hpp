@@ -8,5 +8,6 @@ void dijkstraTests();
 void dsuTests();
 void steinerForestTests();
 void BidirectionalDijkstraTests();
+void solverTests();
 
 #endif
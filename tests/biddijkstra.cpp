@@ -2,6 +2,7 @@
 #include "../utils/BidDijkstra.hpp"
 #include <iostream>
 #include <memory>
+#include <string>
 #include <cassert>
 
 /**
@@ -28,11 +29,7 @@ static bool verifyPath(const Graph& g, const std::vector<int>& pathEdges,
   return true;
 }
 
-void BidirectionalDijkstraTests() {
-  std::cout << "\n========================================" << std::endl;
-  std::cout << "      STARTING BIDIRECTIONAL DIJKSTRA TEST    " << std::endl;
-  std::cout << "========================================" << std::endl;
-
+static void testEngine(const QueueKind queue, const std::string& tag) {
   // Helper lambda to find edge index for mask testing
   auto getEdgeIdx = [](const Graph& g, int u, int v) {
       for (int i = 0; i < (int)g.edges.size(); ++i) {
@@ -41,63 +38,117 @@ void BidirectionalDijkstraTests() {
       return -1;
   };
 
-  std::cout << "[Bi-DIJKSTRA] Simple Path... ";
+  std::cout << tag << "Simple Path... ";
   // 0-1 (10), 1-2 (10)
   Graph g1({{0, 1, 10.0f}, {1, 2, 10.0f}}, 3);
-  auto engine1 = std::make_shared<BidirectionalDijkstraEngine>(std::make_shared<Graph>(g1));
+  auto engine1 = BidirectionalDijkstraEngine::create(std::make_shared<Graph>(g1), nullptr, queue);
   auto res1 = engine1->getShortPath(0, 2);
   assert(verifyPath(g1, res1.first, {0, 1, 2}));
   assert(res1.second == 20.0f);
   std::cout << "Passed." << std::endl;
 
-  std::cout << "[Bi-DIJKSTRA] Shortcut (Dense check)... ";
+  std::cout << tag << "Shortcut (Dense check)... ";
   // 0-1 (10), 1-2 (10), 0-2 (5)
   Graph g2({{0, 1, 10.0f}, {1, 2, 10.0f}, {0, 2, 5.0f}}, 3);
-  auto engine2 = std::make_shared<BidirectionalDijkstraEngine>(std::make_shared<Graph>(g2));
+  auto engine2 = BidirectionalDijkstraEngine::create(std::make_shared<Graph>(g2), nullptr, queue);
   auto res2 = engine2->getShortPath(0, 2);
   assert(verifyPath(g2, res2.first, {0, 2}));
   assert(res2.second == 5.0f);
   std::cout << "Passed." << std::endl;
 
-  std::cout << "[Bi-DIJKSTRA] Unreachable... ";
+  std::cout << tag << "Unreachable... ";
   // Components {0,1} and {2,3}
   Graph g3({{0, 1, 5.0f}, {2, 3, 5.0f}}, 4);
-  auto engine3 = std::make_shared<BidirectionalDijkstraEngine>(std::make_shared<Graph>(g3));
+  auto engine3 = BidirectionalDijkstraEngine::create(std::make_shared<Graph>(g3), nullptr, queue);
   auto res3 = engine3->getShortPath(0, 3);
   assert(res3.first.empty());
   assert(res3.second == -1.0f);
   std::cout << "Passed." << std::endl;
 
-  std::cout << "[Bi-DIJKSTRA] Ditch Mask (Obstacle)... ";
+  std::cout << tag << "Ditch Mask (Obstacle)... ";
   Graph g4({{0, 1, 10.0f}, {1, 2, 10.0f}, {0, 3, 50.0f}, {3, 2, 50.0f}}, 4);
-  auto engine4 = std::make_shared<BidirectionalDijkstraEngine>(std::make_shared<Graph>(g4));
+  auto engine4 = BidirectionalDijkstraEngine::create(std::make_shared<Graph>(g4), nullptr, queue);
   
-  std::vector<uint8_t> ditchMask(g4.edges.size(), 0);
+  EdgeMask ditchMask(g4.edges.size());
   int blockedEdge = getEdgeIdx(g4, 0, 1);
-  ditchMask[blockedEdge] = 1;
   // Also block the reverse direction for undirected consistency
-  ditchMask[g4.edges[blockedEdge].reverseEdgePtr] = 1;
+  ditchMask.set(blockedEdge, g4.edges[blockedEdge].reverseEdgePtr, EDGE_DITCH);
 
-  auto res4 = engine4->getShortPath(0, 2, nullptr, &ditchMask);
+  auto res4 = engine4->getShortPath(0, 2, &ditchMask);
   // Must take the expensive path 0-3-2 because 0-1 is blocked
   assert(verifyPath(g4, res4.first, {0, 3, 2}));
   assert(res4.second == 100.0f);
   std::cout << "Passed." << std::endl;
 
-  std::cout << "[Bi-DIJKSTRA] Bridge Mask (Zero-cost)... ";
-  std::vector<uint8_t> bridgeMask(g4.edges.size(), 0);
+  std::cout << tag << "Bridge Mask (Zero-cost)... ";
+  EdgeMask bridgeMask(g4.edges.size());
   int freeEdge1 = getEdgeIdx(g4, 0, 3);
   int freeEdge2 = getEdgeIdx(g4, 3, 2);
-  bridgeMask[freeEdge1] = 1;
-  bridgeMask[freeEdge2] = 1;
-  bridgeMask[g4.edges[freeEdge1].reverseEdgePtr] = 1;
-  bridgeMask[g4.edges[freeEdge2].reverseEdgePtr] = 1;
+  bridgeMask.set(freeEdge1, g4.edges[freeEdge1].reverseEdgePtr, EDGE_BRIDGE);
+  bridgeMask.set(freeEdge2, g4.edges[freeEdge2].reverseEdgePtr, EDGE_BRIDGE);
 
-  auto res5 = engine4->getShortPath(0, 2, &bridgeMask, nullptr);
+  auto res5 = engine4->getShortPath(0, 2, &bridgeMask);
   assert(verifyPath(g4, res5.first, {0, 3, 2}));
   assert(res5.second == 0.0f);
   std::cout << "Passed." << std::endl;
 
+  std::cout << tag << "Cost Budget... ";
+  // Only paths strictly cheaper than the budget are returned
+  auto res6 = engine4->getShortPath(0, 2, &ditchMask, -1, 101.0f);
+  assert(verifyPath(g4, res6.first, {0, 3, 2}));
+  auto res7 = engine4->getShortPath(0, 2, &ditchMask, -1, 100.0f);
+  assert(res7.first.empty());
+  assert(res7.second == -1.0f);
+  assert(engine4->getShortPath(0, 2, nullptr, -1, 25.0f).second == 20.0f);
+  std::cout << "Passed." << std::endl;
+
+  std::cout << tag << "ALT Landmarks == Plain... ";
+  // 9x9 grid with uneven weights
+  std::vector<std::tuple<int, int, float>> gridEdges;
+  for (int u = 0; u < 81; ++u) {
+    if (u % 9 != 8) gridEdges.push_back({u, u + 1, 1.0f + (u * 7) % 5});
+    if (u < 72) gridEdges.push_back({u, u + 9, 1.0f + (u * 3) % 4});
+  }
+  auto grid = std::make_shared<Graph>(gridEdges, 81);
+  auto reference = BidirectionalDijkstraEngine::create(grid, nullptr, QueueKind::BINARY);
+  auto plain = BidirectionalDijkstraEngine::create(grid, nullptr, queue);
+  auto alt = BidirectionalDijkstraEngine::create(grid, std::make_shared<const Landmarks>(grid, 4), queue);
+
+  EdgeMask gridDitchs(grid->nEdges);
+  for (int i = 0; i < grid->nEdges; i += 5) gridDitchs.set(i, EDGE_DITCH);
+
+  for (int s = 0; s < 81; s += 4)
+    for (int t = 80; t > s; t -= 7) {
+      float expected = reference->getShortPath(s, t).second;
+      assert(plain->getShortPath(s, t).second == expected);
+      assert(alt->getShortPath(s, t).second == expected);
+      // Edge states disable the potential, results must still agree
+      assert(alt->getShortPath(s, t, &gridDitchs).second ==
+             reference->getShortPath(s, t, &gridDitchs).second);
+      // A budget just above the distance does not change it
+      assert(alt->getShortPath(s, t, nullptr, -1, expected + 0.5f).second == expected);
+    }
+  std::cout << "Passed." << std::endl;
+
+  std::cout << tag << "Compact Labels... ";
+  // Hop counters only exist once a query needs them, the search is the same
+  auto compact = BidirectionalDijkstraEngine::create(grid, nullptr, queue);
+  float unbounded = compact->getShortPath(0, 80, &gridDitchs).second;
+  size_t before = compact->memoryBytes();
+  assert(compact->getShortPath(0, 80, &gridDitchs, 1000).second == unbounded);
+  assert(compact->memoryBytes() == before + 2 * 81 * sizeof(int));
+  std::cout << "Passed." << std::endl;
+}
+
+void BidirectionalDijkstraTests() {
+  std::cout << "\n========================================" << std::endl;
+  std::cout << "      STARTING BIDIRECTIONAL DIJKSTRA TEST    " << std::endl;
+  std::cout << "========================================" << std::endl;
+
+  testEngine(QueueKind::BINARY, "[Bi-DIJKSTRA] ");
+  testEngine(QueueKind::QUATERNARY, "[Bi-DIJKSTRA/4-ary] ");
+  testEngine(QueueKind::RADIX, "[Bi-DIJKSTRA/Radix] ");
+
   std::cout << "========================================" << std::endl;
   std::cout << "      ALL BI-DIJKSTRA TESTS PASSED            " << std::endl;
   std::cout << "========================================" << std::endl;
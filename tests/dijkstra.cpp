@@ -4,6 +4,7 @@
 
 #include <iostream>
 #include <memory>
+#include <string>
 
 // Helper function to verify if the list of EDGE INDICES corresponds to the
 // sequence of NODES
@@ -36,33 +37,65 @@ static bool verifyPath(const Graph& g, const std::vector<int>& pathEdges,
   return true;
 }
 
-void dijkstraTests() {
-  std::cout << std::endl;
-  std::cout << "========================================" << std::endl;
-  std::cout << "          STARTING DIJKSTRA TEST        " << std::endl;
-  std::cout << "========================================" << std::endl;
+static const char* queueName(const QueueKind queue) {
+  switch (queue) {
+    case QueueKind::QUATERNARY: return "4-ary";
+    case QueueKind::RADIX: return "Radix";
+    default: return "Binary";
+  }
+}
+
+static void testQueueOrder(const QueueKind queue) {
+  std::cout << "[Dijkstra/" << queueName(queue) << "] Queue pops in key order... ";
+
+  auto run = [](auto& pq) {
+    // Monotone pushes, like Dijkstra: keys never go below the last pop
+    float keys[] = {7.0f, 3.0f, 12.5f, 3.0f, 0.0f, 40.0f};
+    for (int v = 0; v < 6; ++v) pq.push(keys[v], v);
+    float last = -1.0f;
+    int popped = 0;
+    while (!pq.empty()) {
+      auto [key, v] = pq.pop();
+      assert(key >= last);
+      last = key;
+      if (popped++ == 2) pq.push(key + 1.0f, 6);
+    }
+    assert(popped == 7);
+    pq.clear();
+    assert(pq.empty());
+  };
+
+  if (queue == QueueKind::QUATERNARY) { QuaternaryHeap pq(7, 0); run(pq); }
+  else if (queue == QueueKind::RADIX) { RadixHeap pq(7, 0); run(pq); }
+  else { BinaryHeap pq(7, 0); run(pq); }
+
+  std::cout << "-> Passed." << std::endl;
+}
+
+static void testEngine(const QueueKind queue) {
+  const std::string tag = std::string("[Dijkstra/") + queueName(queue) + "] ";
 
-  std::cout << "[Dijkstra] Simple path check... ";
+  std::cout << tag << "Simple path check... ";
 
   // Graph: 0-1 (10), 1-2 (10)
   Graph g1({{0, 1, 10.0f}, {1, 2, 10.0f}}, 3);
 
   // Setup Engine for 3 nodes
-  DijkstraEngine engine1(std::make_shared<Graph>(g1));
-  auto res1 = engine1.getShortPath(0, 2);
+  auto engine1 = DijkstraEngine::create(std::make_shared<Graph>(g1), queue);
+  auto res1 = engine1->getShortPath(0, 2);
 
   // Expect: 0 -> 1 -> 2
   assert(verifyPath(g1, res1.first, {0, 1, 2}));
   assert(res1.second == 20.0f);
   std::cout << "-> Passed." << std::endl;
 
-  std::cout << "[Dijkstra] Shortcut check... ";
+  std::cout << tag << "Shortcut check... ";
 
   // 0-1 (10), 1-2 (10), 0-2 (5)
   Graph g2({{0, 1, 10.0f}, {1, 2, 10.0f}, {0, 2, 5.0f}}, 3);
 
-  DijkstraEngine engine2(std::make_shared<Graph>(g2));
-  auto res2 = engine2.getShortPath(0, 2);
+  auto engine2 = DijkstraEngine::create(std::make_shared<Graph>(g2), queue);
+  auto res2 = engine2->getShortPath(0, 2);
 
   // Expect: 0 -> 2 (Direct path is cheaper)
   assert(verifyPath(g2, res2.first, {0, 2}));
@@ -70,13 +103,13 @@ void dijkstraTests() {
 
   std::cout << "-> Passed." << std::endl;
 
-  std::cout << "[Dijkstra] Unreachable check... ";
+  std::cout << tag << "Unreachable check... ";
 
   // Graph: Disconnected components {0, 1} and {2, 3}
   Graph g3({{0, 1, 5.0f}, {2, 3, 5.0f}}, 4);
 
-  DijkstraEngine engine3(std::make_shared<Graph>(g3));
-  auto res3 = engine3.getShortPath(0, 3);
+  auto engine3 = DijkstraEngine::create(std::make_shared<Graph>(g3), queue);
+  auto res3 = engine3->getShortPath(0, 3);
 
   // Expect: Empty path and cost -1 (or whatever your logic for infinity is)
   assert(res3.first.empty());
@@ -84,7 +117,7 @@ void dijkstraTests() {
 
   std::cout << "-> Passed." << std::endl;
 
-  std::cout << "[Dijkstra] Dynamic Obstacle (Ditch Bitmask)... ";
+  std::cout << tag << "Dynamic Obstacle (Ditch Bitmask)... ";
 
   Graph g4(
       {
@@ -95,8 +128,8 @@ void dijkstraTests() {
       },
       4);
 
-  DijkstraEngine engine4(std::make_shared<Graph>(g4));
-  auto run1 = engine4.getShortPath(0, 2);
+  auto engine4 = DijkstraEngine::create(std::make_shared<Graph>(g4), queue);
+  auto run1 = engine4->getShortPath(0, 2);
 
   assert(verifyPath(g4, run1.first, {0, 1, 2}));
   assert(run1.second == 20.0f);
@@ -110,30 +143,71 @@ void dijkstraTests() {
   };
 
   // ZERO-COPY: Block the cheap path
-  std::vector<uint8_t> ditchMask(g4.edges.size(), 0);
-  ditchMask[getEdgeIdx(0, 1)] = true; 
+  EdgeMask ditchMask(g4.edges.size());
+  ditchMask.set(getEdgeIdx(0, 1), EDGE_DITCH);
 
-  auto run2 = engine4.getShortPath(0, 2, nullptr, &ditchMask);
+  auto run2 = engine4->getShortPath(0, 2, &ditchMask);
 
   assert(verifyPath(g4, run2.first, {0, 3, 2}));
   assert(run2.second == 100.0f);
 
   std::cout << "-> Passed." << std::endl;
 
-  std::cout << "[Dijkstra] Zero-Cost Path (Bridge Bitmask)... ";
+  std::cout << tag << "Zero-Cost Path (Bridge Bitmask)... ";
 
   // ZERO-COPY: Make the expensive path completely free
-  std::vector<uint8_t> bridgeMask(g4.edges.size(), 0);
-  bridgeMask[getEdgeIdx(0, 3)] = true; 
-  bridgeMask[getEdgeIdx(3, 2)] = true; 
+  EdgeMask bridgeMask(g4.edges.size());
+  bridgeMask.set(getEdgeIdx(0, 3), EDGE_BRIDGE);
+  bridgeMask.set(getEdgeIdx(3, 2), EDGE_BRIDGE);
 
-  auto run3 = engine4.getShortPath(0, 2, &bridgeMask, nullptr);
+  auto run3 = engine4->getShortPath(0, 2, &bridgeMask);
 
   // Should take the now-free path (0-3-2)
   assert(verifyPath(g4, run3.first, {0, 3, 2}));
   assert(run3.second == 0.0f);
 
+  // A ditch wins over a bridge on the same edge
+  bridgeMask.set(getEdgeIdx(3, 2), EDGE_BRIDGE | EDGE_DITCH);
+  auto run4 = engine4->getShortPath(0, 2, &bridgeMask);
+  assert(verifyPath(g4, run4.first, {0, 1, 2}));
+  assert(run4.second == 20.0f);
+
+  std::cout << "-> Passed." << std::endl;
+
+  std::cout << tag << "One-to-many query... ";
+
+  // 0-1 (10), 1-2 (10), 0-3 (50), 3-2 (50) plus the isolated node 4
+  Graph g5({{0, 1, 10.0f}, {1, 2, 10.0f}, {0, 3, 50.0f}, {3, 2, 50.0f}}, 5);
+  auto engine5 = DijkstraEngine::create(std::make_shared<Graph>(g5), queue);
+  std::vector<std::vector<int>> paths;
+  auto costs = engine5->getShortPaths(0, {2, 3, 0, 4, 2}, nullptr, &paths);
+  assert(costs == std::vector<float>({20.0f, 50.0f, 0.0f, -1.0f, 20.0f}));
+  assert(verifyPath(g5, paths[0], {0, 1, 2}));
+  assert(verifyPath(g5, paths[1], {0, 3}));
+  assert(paths[2].empty() && paths[3].empty());
+  assert(paths[4] == paths[0]);
+
+  // Same costs as single queries, with an edge state
+  EdgeMask state(g5.nEdges);
+  state.set(1, g5.rev[1], EDGE_DITCH);
+  costs = engine5->getShortPaths(1, {2, 3});
+  for (int t : {2, 3}) assert(costs[t - 2] == engine5->getShortPath(1, t).second);
+  costs = engine5->getShortPaths(1, {2, 3}, &state);
+  for (int t : {2, 3}) assert(costs[t - 2] == engine5->getShortPath(1, t, &state).second);
+
   std::cout << "-> Passed." << std::endl;
+}
+
+void dijkstraTests() {
+  std::cout << std::endl;
+  std::cout << "========================================" << std::endl;
+  std::cout << "          STARTING DIJKSTRA TEST        " << std::endl;
+  std::cout << "========================================" << std::endl;
+
+  for (QueueKind queue : {QueueKind::BINARY, QueueKind::QUATERNARY, QueueKind::RADIX}) {
+    testQueueOrder(queue);
+    testEngine(queue);
+  }
 
   std::cout << "========================================" << std::endl;
   std::cout << "      ALL TESTS PASSED SUCCESSFULLY     " << std::endl;
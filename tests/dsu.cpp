@@ -15,10 +15,10 @@ static void testConstructionAndBasics() {
   // 1. Check initial component count
   assert(dsu.components == nNodes);
 
-  // 2. Check that every node is its own parent initially
+  // 2. Check that every node is a root of size one initially
   for (int i = 0; i < nNodes; ++i) {
-    assert(dsu.parent[i] == i);
-    assert(dsu.rank[i] == 0);
+    assert(dsu.parent[i] == -1);
+    assert(dsu.size(i) == 1);
     assert(dsu.find(i) == i);
   }
 
@@ -63,11 +63,11 @@ static void testUnionAndFind() {
 }
 
 /**
- * @brief Tests the Path Compression optimization indirectly.
- * Logic: Construct a tall tree (line) and check if find() flattens it.
+ * @brief Tests the Path Halving optimization.
+ * Logic: Construct a tall tree (line) and check that find() halves it.
  */
-static void testPathCompression() {
-  std::cout << "[Test] Path Compression Logic...";
+static void testPathHalving() {
+  std::cout << "[Test] Path Halving Logic...";
 
   int n = 5;
   DSU dsu(n);
@@ -79,20 +79,23 @@ static void testPathCompression() {
   dsu.parent[1] = 2;
   dsu.parent[2] = 3;
   dsu.parent[3] = 4;
-  dsu.parent[4] = 4;  // Root
+  dsu.parent[4] = -5;  // Root of the 5 nodes
 
   // Before find(0), parent of 0 is 1.
   assert(dsu.parent[0] == 1);
 
-  // Execute find(0). This should traverse up to 4 and update all parents on
-  // path.
+  // Execute find(0). This should traverse up to 4, linking every other node
+  // of the path to its grandparent.
   int root = dsu.find(0);
   assert(root == 4);
+  assert(dsu.parent[0] == 2);
+  assert(dsu.parent[2] == 4);
+  assert(dsu.parent[1] == 2);  // Skipped node keeps its parent
 
-  // Check compression: parent of 0 should now be 4 directly.
+  // A second find() flattens the path of 0 completely.
+  assert(dsu.find(0) == 4);
   assert(dsu.parent[0] == 4);
-  // Parent of 1 (on the path) should also be 4 now (recursive compression).
-  assert(dsu.parent[1] == 4);
+  assert(dsu.size(1) == 5);
 
   std::cout << " -> Passed." << std::endl;
 }
@@ -116,10 +119,7 @@ static void testReset() {
 
   // Validate initial state
   assert(dsu.components == 5);
-  for (int i = 0; i < 5; ++i) {
-    assert(dsu.parent[i] == i);
-    assert(dsu.rank[i] == 0);
-  }
+  for (int i = 0; i < 5; ++i) assert(dsu.parent[i] == -1);
 
   // Ensure connectivity is gone
   assert(dsu.isConnected(0, 1) == false);
@@ -128,29 +128,53 @@ static void testReset() {
 }
 
 /**
- * @brief Tests Union by Rank logic.
+ * @brief Tests Union by Size logic.
  * Ensures the smaller tree is attached to the larger tree root.
  */
-static void testUnionByRank() {
-  std::cout << "[Test] Union By Rank...";
+static void testUnionBySize() {
+  std::cout << "[Test] Union By Size...";
 
   DSU dsu(4);
 
-  // Make tree {0, 1} with root 1 (assuming 1 becomes root due to logic or
-  // index) Initially rank 0 vs 0. Implementation usually picks one.
+  // Make tree {0, 1}, either node may become the root
   dsu.unite(0, 1);
   int root01 = dsu.find(0);
-  assert(dsu.rank[root01] == 1);  // Rank should increase to 1
+  assert(dsu.size(0) == 2);
+
+  // Union {2} with {0,1}: the single node joins the larger tree even when
+  // it is passed first.
+  dsu.unite(2, root01);
+
+  assert(dsu.find(2) == root01);
+  assert(dsu.parent[2] == root01);
+  assert(dsu.size(2) == 3);
+  assert(dsu.size(3) == 1);
+
+  std::cout << " -> Passed." << std::endl;
+}
 
-  // Make element 2 independent (Rank 0)
+/**
+ * @brief Tests the O(1) reset of the sparse DSU.
+ */
+static void testSparseReset() {
+  std::cout << "[Test] Sparse DSU Reset...";
 
-  // Union {0,1} with {2}.
-  // Rank of {0,1} is 1. Rank of {2} is 0.
-  // {2} should become child of {0,1}'s root.
-  dsu.unite(root01, 2);
+  SparseDSU dsu(6);
+  assert(dsu.unite(0, 1) && dsu.unite(1, 2) && !dsu.unite(0, 2));
+  assert(dsu.isConnected(0, 2) && !dsu.isConnected(0, 3));
+
+  // Nodes left from the previous query are singletons again
+  dsu.reset();
+  for (int i = 0; i < 6; ++i) assert(dsu.find(i) == i);
+  assert(!dsu.isConnected(0, 1));
+  dsu.unite(4, 5);
+  assert(dsu.isConnected(5, 4) && !dsu.isConnected(1, 2));
 
-  assert(dsu.find(2) == root01);  // 2 points to 1 (or 0)
-  assert(dsu.rank[root01] == 1);  // Rank shouldn't increase (1 > 0)
+  // Growing keeps the current sets
+  dsu.resize(10);
+  assert(dsu.isConnected(4, 5) && dsu.find(9) == 9);
+  dsu.unite(9, 4);
+  assert(dsu.isConnected(9, 5));
 
   std::cout << " -> Passed." << std::endl;
 }
@@ -163,9 +187,10 @@ void dsuTests() {
 
   testConstructionAndBasics();
   testUnionAndFind();
-  testPathCompression();
+  testPathHalving();
   testReset();
-  testUnionByRank();
+  testUnionBySize();
+  testSparseReset();
 
   std::cout << "========================================" << std::endl;
   std::cout << "      ALL DSU TESTS PASSED SUCCESSFULLY " << std::endl;
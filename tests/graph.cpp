@@ -1,5 +1,6 @@
 #include "Tests.hpp"
 
+#include "../utils/EdgeMask.hpp"
 #include "../utils/Graph.hpp"
 
 #include <iostream>
@@ -46,6 +47,65 @@ static void testConstraintFunctions() {
   std::cout << " -> Passed." << std::endl;
 }
 
+static void testReverseLinking() {
+  std::cout << "[Test] Reverse Edge Linking...";
+
+  // Parallel edges 0-1 (weights 4 and 7) plus a triangle and a self-loop
+  auto g = Graph({{0, 1, 4.0f}, {1, 2, 2.0f}, {1, 0, 7.0f}, {2, 0, 1.0f},
+                  {2, 2, 3.0f}},
+                 3);
+
+  for (int i = 0; i < g.nEdges; i++) {
+    const Edge& edge = g.edges[i];
+    const Edge& twin = g.edges[edge.reverseEdgePtr];
+    assert(twin.reverseEdgePtr == i);
+    assert(twin.source == edge.target && twin.target == edge.source);
+    assert(twin.weight == edge.weight);  // Parallel edges are not mixed up
+  }
+
+  // Rows stay sorted by target, parallel edges in input order
+  for (int u = 0; u < g.nNodes; u++)
+    for (int i = g.ptrs[u] + 1; i < g.ptrs[u + 1]; i++)
+      assert(g.edges[i - 1].target <= g.edges[i].target);
+  assert(g.edges[g.ptrs[0]].weight == 4.0f);
+  assert(g.edges[g.ptrs[0] + 1].weight == 7.0f);
+  assert(g.totalWeight == 17.0f);
+
+  std::cout << " -> Passed." << std::endl;
+}
+
+static void testEdgeMask() {
+  std::cout << "[Test] Edge Mask Planes...";
+
+  // Sizes past a word boundary, so the tail block is partial
+  EdgeMask mask(130);
+  assert(mask.size() == 130 && mask.countBridges() == 0 && mask.countDitches() == 0);
+
+  mask.set(3, 129, EDGE_BRIDGE);
+  mask.setDitch(64, -1, true);
+  mask.set(65, EDGE_BRIDGE | EDGE_DITCH);
+  assert(mask.get(3) == EDGE_BRIDGE && mask.get(129) == EDGE_BRIDGE);
+  assert(mask.get(64) == EDGE_DITCH && mask.get(65) == (EDGE_BRIDGE | EDGE_DITCH));
+  assert(mask.get(4) == EDGE_FREE && mask.get(128) == EDGE_FREE);
+  assert(mask.countBridges() == 3 && mask.countDitches() == 2);
+
+  mask.setBridge(3, 129, false);
+  assert(!mask.isBridge(3) && !mask.isBridge(129) && mask.isBridge(65));
+
+  // Bulk operations leave the bits past size() clear
+  EdgeMask full(130, EDGE_DITCH);
+  assert(full.countDitches() == 130 && full.countBridges() == 0);
+  full.clearDitches();
+  assert(full == EdgeMask(130));
+  full.fill(EDGE_BRIDGE);
+  full.andNotBridges(mask);
+  assert(full.countBridges() == 129 && !full.isBridge(65));
+  mask.ditchBridges(full);
+  assert(mask.countDitches() == 130);
+
+  std::cout << " -> Passed." << std::endl;
+}
+
 static void testPrint() {
   std::cout << "[Test] Printing (Visual Check)..." << std::endl;
   auto g = Graph({{0, 1, 1.5f}, {1, 2, 2.5f}}, 3);
@@ -60,6 +120,8 @@ void graphTests() {
 
   testConstructionAndBasics();
   testConstraintFunctions();
+  testReverseLinking();
+  testEdgeMask();
   testPrint();
 
   std::cout << "========================================" << std::endl;
@@ -1,7 +1,11 @@
 #include "Tests.hpp"
 
+#include "../models/Reduction.hpp"
 #include "../models/SFP.hpp"
 
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
 #include <sstream>
 
 /**
@@ -201,6 +205,374 @@ void testIOParsing() {
   std::cout << " -> Passed." << std::endl;
 }
 
+/**
+ * @brief Test 6: Sparse pair overlaps and synergy bookkeeping
+ */
+void testPairOverlaps() {
+  std::cout << "[Test] Pair Overlaps & Synergy...";
+
+  // Path 0-1-2-3, pairs {0,3}, {1,3} and {0,1}
+  std::vector<std::tuple<int, int, float>> edgeList = {{0, 1, 1.0f}, {1, 2, 2.0f}, {2, 3, 3.0f}};
+  auto graph = std::make_shared<Graph>(edgeList, 4);
+  SFPProblem problem(graph, {{0, 3}, {1, 3}, {0, 1}});
+  SFPSolution sol = problem.empty_solution();
+
+  int e01 = findEdgeIndex(*graph, 0, 1);
+  int e12 = findEdgeIndex(*graph, 1, 2);
+  int e23 = findEdgeIndex(*graph, 2, 3);
+
+  SFPNeighborhood neigh;
+  neigh.addMoveApplying(SFPMove(&sol, MoveType::CNCT_PAIR, 0, {e01, e12, e23}));
+  neigh.addMoveApplying(SFPMove(&sol, MoveType::CNCT_PAIR, 1, {e12, e23}));
+  neigh.addMoveApplying(SFPMove(&sol, MoveType::CNCT_PAIR, 2, {e01}));
+
+  assert(sol.getIntersectionsSum(0, 1) == 2);
+  assert(sol.getIntersectionsSum(1, 0) == 2);
+  assert(sol.getIntersectionsSum(0, 2) == 1);
+  assert(sol.getIntersectionsSum(1, 2) == 0);
+  assert(sol.getCompetingPairs(0) == std::vector<int>({1, 2}));
+  assert(sol.getCompetingPairs(1) == std::vector<int>({0}));
+  assert(sol.getPair(0).synergy == 3);
+
+  // Dropping pair 1 must clear its overlaps on both sides
+  SFPMove drop(&sol, MoveType::DSCNCT_PAIR, 1, {e12, e23});
+  drop.apply();
+  assert(sol.getIntersectionsSum(0, 1) == 0);
+  assert(sol.getCompetingPairs(1).empty());
+  assert(sol.getCompetingPairs(0) == std::vector<int>({2}));
+  assert(sol.getPair(0).synergy == 1);
+  assert(sol.getCurrentCost() == 6.0f);
+
+  drop.undo();
+  assert(sol.getIntersectionsSum(0, 1) == 2);
+  assert(sol.getPair(1).synergy == 2);
+
+  std::cout << " -> Passed." << std::endl;
+}
+
+/**
+ * @brief Test 7: Malformed STP input reports the offending line
+ */
+void testParsingErrors() {
+  std::cout << "[Test] Parsing Errors (line numbers)...";
+
+  auto errorOf = [](const std::string& input) -> std::string {
+    std::stringstream ss(input);
+    SFPProblem problem;
+    try {
+      ss >> problem;
+    } catch (const std::exception& e) {
+      return e.what();
+    }
+    return "";
+  };
+
+  std::string header = "SECTION Graph\nNodes 3\nEdges 2\n";
+  std::string terminals = "END\nSECTION Terminals\nTerminals 1\nTP 1 3\nEND\n";
+
+  assert(errorOf(header + "E 1 2 5\nE 2 3 5\n" + terminals).empty());
+  assert(errorOf(header + "E 1 2 5\nE 2 x 5\n" + terminals).find("Line 5") != std::string::npos);
+  assert(errorOf(header + "E 1 2 5\nE 2 9 5\n" + terminals).find("Line 5") != std::string::npos);
+  assert(errorOf(header + "E 1 2 5 7\nE 2 3 5\n" + terminals).find("Line 4") != std::string::npos);
+  assert(errorOf(header + "E 1 2 5\nE 2 3 5\nEND\nSECTION Terminals\nTP 1\nEND\n").find("Line 8") != std::string::npos);
+  // A digit run past the int range is a parse error, not an overflow
+  assert(errorOf(header + "E 1 2 5\nE 2 99999999999999999999999 5\n" + terminals).find("out of range") !=
+         std::string::npos);
+
+  std::cout << " -> Passed." << std::endl;
+}
+
+/**
+ * @brief Test 8: Binary snapshot round trip and version check
+ */
+void testBinarySnapshot() {
+  std::cout << "[Test] Binary Snapshot (.sfpb)...";
+
+  std::stringstream ss(
+      "SECTION Graph\nNodes 4\nEdges 4\nE 1 2 10\nE 2 3 20\nE 3 4 30\nE 1 4 5\nEND\n"
+      "SECTION Terminals\nTerminals 2\nTP 1 3\nTP 2 4\nEND\n");
+  SFPProblem original;
+  ss >> original;
+
+  std::string path = (std::filesystem::temp_directory_path() / "sfp_test_snapshot.sfpb").string();
+  original.saveBinary(path);
+
+  SFPProblem loaded;
+  loaded.loadFile(path);
+
+  const Graph& a = *original.getGraphPtr();
+  const Graph& b = *loaded.getGraphPtr();
+  assert(a.ptrs == b.ptrs);
+  assert(a.nEdges == b.nEdges && a.totalWeight == b.totalWeight);
+  for (int i = 0; i < a.nEdges; ++i) {
+    assert(a.edges[i].source == b.edges[i].source);
+    assert(a.edges[i].target == b.edges[i].target);
+    assert(a.edges[i].reverseEdgePtr == b.edges[i].reverseEdgePtr);
+    assert(a.edges[i].weight == b.edges[i].weight);
+  }
+  assert(original.getTerminals() == loaded.getTerminals());
+
+  // Give edge 0 a weight its twin does not share (32-byte header, 5 row pointers)
+  {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(32 + 5 * sizeof(int) + offsetof(Edge, weight));
+    float weight = 1000.0f;
+    file.write(reinterpret_cast<const char*>(&weight), sizeof(weight));
+  }
+  bool mismatched = false;
+  try {
+    SFPProblem corrupt;
+    corrupt.loadFile(path);
+  } catch (const std::exception& e) {
+    mismatched = std::string(e.what()).find("twins") != std::string::npos;
+  }
+  assert(mismatched);
+
+  // Corrupt the version field
+  {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(4);
+    uint32_t version = 99;
+    file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+  }
+  bool rejected = false;
+  try {
+    SFPProblem stale;
+    stale.loadFile(path);
+  } catch (const std::exception& e) {
+    rejected = std::string(e.what()).find("version") != std::string::npos;
+  }
+  assert(rejected);
+  std::filesystem::remove(path);
+
+  std::cout << " -> Passed." << std::endl;
+}
+
+/**
+ * @brief Test 9: Reroute pricing without touching the solution
+ */
+void testRerouteEvaluation() {
+  std::cout << "[Test] Reroute Evaluation...";
+
+  // Square 0-1-2-3 with the diagonal 0-2, pairs {0,2} and {1,2}
+  std::vector<std::tuple<int, int, float>> edgeList = {
+      {0, 1, 1.0f}, {1, 2, 2.0f}, {2, 3, 3.0f}, {3, 0, 4.0f}, {0, 2, 2.5f}};
+  auto graph = std::make_shared<Graph>(edgeList, 4);
+  SFPProblem problem(graph, {{0, 2}, {1, 2}});
+  SFPSolution sol = problem.empty_solution();
+
+  int e01 = findEdgeIndex(*graph, 0, 1);
+  int e12 = findEdgeIndex(*graph, 1, 2);
+  int e21 = findEdgeIndex(*graph, 2, 1);
+  int e03 = findEdgeIndex(*graph, 0, 3);
+  int e32 = findEdgeIndex(*graph, 3, 2);
+  int e02 = findEdgeIndex(*graph, 0, 2);
+
+  sol.insert(e01, 0);
+  sol.insert(e12, 0);
+  sol.insert(e21, 1);
+  assert(sol.getCurrentCost() == 3.0f);
+
+  // Only 0-1 is left without pairs, 1-2 is kept by pair 1
+  std::vector<int> released;
+  sol.releasedEdges({0}, released);
+  assert(released == std::vector<int>({std::min(e01, graph->rev[e01])}));
+  sol.releasedEdges({0, 1}, released);
+  assert(released.size() == 2);
+
+  assert(sol.evaluateReroute({0}, {{e02}}) == 1.5);
+  assert(sol.evaluateReroute({0}, {{e03, e32}}) == 6.0);
+  // Both pairs rerouted, 1-2 is freed and paid again by the second path
+  assert(sol.evaluateReroute({0, 1}, {{e03, e32}, {e12}}) == 6.0);
+  assert(sol.evaluateReroute({0, 1}, {{e02}, {e12, e02}}) == 1.5);
+
+  // Nothing changed, and the prices match the applied moves
+  assert(sol.getCurrentCost() == 3.0f);
+  assert(sol.getNEdges() == 2);
+  double expected = sol.getCurrentCost() + sol.evaluateReroute({0, 1}, {{e03, e32}, {e12}});
+  SFPNeighborhood reroute;
+  reroute.addMoveApplying(SFPMove(&sol, MoveType::DSCNCT_PAIR, 0, *sol.getPairEdges(0)));
+  reroute.addMoveApplying(SFPMove(&sol, MoveType::DSCNCT_PAIR, 1, *sol.getPairEdges(1)));
+  reroute.addMoveApplying(SFPMove(&sol, MoveType::CNCT_PAIR, 0, {e03, e32}));
+  reroute.addMoveApplying(SFPMove(&sol, MoveType::CNCT_PAIR, 1, {e12}));
+  assert(sol.getCurrentCost() == expected);
+
+  std::cout << " -> Passed." << std::endl;
+}
+
+/**
+ * @brief Test 10: reset/reinit empty the solution and keep it usable
+ */
+void testResetReinit() {
+  std::cout << "[Test] Reset & Reinit...";
+
+  std::vector<std::tuple<int, int, float>> edgeList = {{0, 1, 5.0f}, {1, 2, 8.0f}, {2, 3, 10.0f}};
+  auto graph = std::make_shared<Graph>(edgeList, 4);
+  SFPProblem problem(graph, {{0, 2}, {1, 3}});
+  SFPSolution sol = problem.empty_solution();
+
+  int e01 = findEdgeIndex(*graph, 0, 1);
+  int e12 = findEdgeIndex(*graph, 1, 2);
+  int e23 = findEdgeIndex(*graph, 2, 3);
+
+  auto connectAll = [&](SFPSolution& s) {
+    s.insert(e01, 0);
+    s.insert(e12, 0);
+    s.insert(e12, 1);
+    s.insert(e23, 1);
+  };
+  connectAll(sol);
+  assert(sol.getCurrentCost() == 23.0f);
+
+  sol.reset();
+  assert(sol.getCurrentCost() == 0.0);
+  assert(sol.getNEdges() == 0);
+  assert(sol.getNPairs() == 2);
+  assert(sol.getPairEdges(0)->empty() && sol.getPair(1).synergy == 0);
+  assert(sol.getBitmask()->countBridges() == 0 && sol.getBitmask()->countDitches() == 0);
+
+  // Same bookkeeping as a fresh solution
+  SFPSolution fresh = problem.empty_solution();
+  connectAll(sol);
+  connectAll(fresh);
+  assert(sol.getCurrentCost() == fresh.getCurrentCost());
+  assert(sol.getIntersectionsSum(0, 1) == fresh.getIntersectionsSum(0, 1));
+  assert(*sol.getEdgePairs(e12) == *fresh.getEdgePairs(e12));
+
+  // New pairs replace the terminals
+  sol.reinit({{3, 0}});
+  assert(sol.getNPairs() == 1);
+  assert(sol.getPairNodes(0) == std::make_pair(0, 3));
+  assert(sol.isTerminal(0) && sol.isTerminal(3));
+  assert(!sol.isTerminal(1) && !sol.isTerminal(2));
+  sol.insert(e01, 0);
+  sol.insert(e12, 0);
+  sol.insert(e23, 0);
+  assert(sol.getCurrentCost() == 23.0f);
+  assert(sol.getPair(0).pathCost == 23.0);
+
+  std::cout << " -> Passed." << std::endl;
+}
+
+/**
+ * @brief Test 11: Solution snapshots and the solution file round trip
+ */
+void testSolutionSnapshot() {
+  std::cout << "[Test] Solution Snapshot...";
+
+  std::vector<std::tuple<int, int, float>> edgeList = {
+      {0, 1, 1.0f}, {1, 2, 2.0f}, {2, 3, 3.0f}, {3, 0, 4.0f}, {0, 2, 2.5f}};
+  auto graph = std::make_shared<Graph>(edgeList, 4);
+  SFPProblem problem(graph, {{0, 2}, {1, 3}});
+  SFPSolution sol = problem.empty_solution();
+
+  int e01 = findEdgeIndex(*graph, 0, 1);
+  int e12 = findEdgeIndex(*graph, 1, 2);
+  int e23 = findEdgeIndex(*graph, 2, 3);
+  sol.insert(e01, 0);
+  sol.insert(e12, 0);
+  sol.insert(e12, 1);
+  sol.insert(e23, 1);
+
+  SFPSnapshot snapshot;
+  assert(!snapshot.captured());
+  snapshot.capture(sol);
+  assert(snapshot.captured());
+  assert(snapshot.cost == sol.getCurrentCost());
+  assert(snapshot.edges.size() == 3);
+  assert(snapshot.pathOffsets == std::vector<int>({0, 2, 4}));
+
+  auto samePaths = [&](const SFPSolution& a, const SFPSolution& b) {
+    assert(a.getCurrentCost() == b.getCurrentCost());
+    assert(a.getNEdges() == b.getNEdges() && a.isFeasible() == b.isFeasible());
+    for (int p = 0; p < a.getNPairs(); ++p) {
+      assert(a.getPairNodes(p) == b.getPairNodes(p));
+      assert(*a.getPairEdges(p) == *b.getPairEdges(p));
+    }
+  };
+
+  // Restoring over another solution replaces it entirely
+  SFPSolution other = problem.empty_solution();
+  other.insert(findEdgeIndex(*graph, 0, 2), 0);
+  snapshot.restore(other);
+  samePaths(sol, other);
+  samePaths(sol, snapshot.toSolution(&problem));
+
+  std::string path = (std::filesystem::temp_directory_path() / "sfp_test_solution.sol").string();
+  snapshot.save(path, problem);
+  SFPSnapshot loaded;
+  loaded.load(path, problem);
+  assert(loaded.pairs == snapshot.pairs && loaded.pathOffsets == snapshot.pathOffsets);
+  assert(loaded.edges == snapshot.edges && loaded.cost == snapshot.cost);
+  samePaths(sol, loaded.toSolution(&problem));
+
+  // Truncated file
+  {
+    std::ofstream file(path);
+    file << "SFP SOLUTION 1\nPairs 1\nP 1 3 2\nE 1 2\n";
+  }
+  bool rejected = false;
+  try {
+    SFPSnapshot broken;
+    broken.load(path, problem);
+  } catch (const std::exception& e) {
+    rejected = std::string(e.what()).find("Line 5") != std::string::npos;
+  }
+  assert(rejected);
+  std::filesystem::remove(path);
+
+  std::cout << " -> Passed." << std::endl;
+}
+
+/**
+ * @brief Test 12: Reductions and the expansion of reduced solutions
+ */
+void testReductions() {
+  std::cout << "[Test] Instance Reductions...";
+
+  // Chain 0-1-2-3 (degree-2 nodes), long edge 0-3, dangling path 3-4-5
+  std::vector<std::tuple<int, int, float>> edgeList = {
+      {0, 1, 1.0f}, {1, 2, 1.0f}, {2, 3, 1.0f}, {0, 3, 5.0f}, {3, 4, 2.0f}, {4, 5, 1.0f}};
+  auto graph = std::make_shared<Graph>(edgeList, 6);
+  SFPProblem problem(graph, {{0, 3}});
+
+  SFPReduction reduction(problem);
+  const auto& stats = reduction.getStats();
+  assert(stats.longEdges == 1 && stats.contracted + stats.leaves == 4);
+  assert(stats.nodesBefore == 6 && stats.nodesAfter == 2);
+  assert(stats.edgesBefore == 6 && stats.edgesAfter == 1);
+
+  const SFPProblem& reduced = reduction.getReduced();
+  const Graph& small = *reduced.getGraphPtr();
+  assert(small.totalWeight == 3.0f);
+  auto [s, t] = reduced.getTerminals()[0];
+  assert(reduction.getOriginalNode(s) == 0 && reduction.getOriginalNode(t) == 3);
+
+  // The reduced edge stands for the chain, in both directions
+  int forward = small.findEdge(s, t);
+  for (int id : {forward, small.rev[forward]}) {
+    const auto& path = reduction.getOriginalPath(id);
+    assert(path.size() == 3);
+    int at = reduction.getOriginalNode(small.edges[id].source);
+    for (int e : path) {
+      assert(graph->edges[e].source == at);
+      at = graph->edges[e].target;
+    }
+    assert(at == reduction.getOriginalNode(small.edges[id].target));
+  }
+
+  SFPSolution sol = reduced.empty_solution();
+  sol.insert(forward, 0);
+  SFPSolution expanded = reduction.expand(sol);
+  assert(expanded.getProblem() == &problem);
+  assert(expanded.isFeasible());
+  assert(expanded.getCurrentCost() == 3.0);
+  assert(expanded.getPairNodes(0) == std::make_pair(0, 3));
+  assert(expanded.getPairEdges(0)->size() == 3);
+
+  std::cout << " -> Passed." << std::endl;
+}
+
 void steinerForestTests() {
   std::cout << "========================================" << std::endl;
   std::cout << "         STARTING SFP TEST SUITE        " << std::endl;
@@ -211,6 +583,13 @@ void steinerForestTests() {
   testNeighborhoods();
   testFeasibility();
   testIOParsing();
+  testPairOverlaps();
+  testParsingErrors();
+  testBinarySnapshot();
+  testRerouteEvaluation();
+  testResetReinit();
+  testSolutionSnapshot();
+  testReductions();
 
   std::cout << "========================================" << std::endl;
   std::cout << "      ALL TESTS PASSED SUCCESSFULLY     " << std::endl;
@@ -0,0 +1,642 @@
+#include "Tests.hpp"
+
+#include "../algorithms/Batch.hpp"
+#include "../algorithms/Service.hpp"
+#include "../algorithms/Solver.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <thread>
+
+/**
+ * @brief Helper that builds a weighted grid instance with a few terminal pairs.
+ */
+static SFPProblem makeGridProblem(const int side, const int extraPairs = 0) {
+  std::vector<std::tuple<int, int, float>> edgeList;
+  for (int r = 0; r < side; ++r)
+    for (int c = 0; c < side; ++c) {
+      int u = r * side + c;
+      if (c + 1 < side) edgeList.push_back({u, u + 1, 1.0f + (u * 7) % 5});
+      if (r + 1 < side) edgeList.push_back({u, u + side, 1.0f + (u * 3) % 4});
+    }
+
+  int last = side * side - 1;
+  std::vector<std::pair<int, int>> terminals = {
+      {0, last}, {side - 1, last - side + 1}, {side / 2, last - side / 2}, {0, side * (side / 2)}};
+  for (int k = 1; k <= extraPairs; ++k) {
+    int u = (k * 31) % (last + 1), v = (k * 57 + 13) % (last + 1);
+    if (u != v) terminals.push_back({u, v});
+  }
+
+  SFPProblem problem(std::make_shared<Graph>(edgeList, side * side), terminals);
+  problem.setName("GridTest");
+  return problem;
+}
+
+/**
+ * @brief Test 1: Same seed and thread count must give the same result.
+ */
+static void testReproducibleRuns() {
+  std::cout << "[Test] Reproducible Seeded Runs...";
+
+  SFPProblem problem = makeGridProblem(8);
+
+  SolverConfig config;
+  config.maxIterations = 12;
+  config.alpha = 0.6f;
+  config.seed = 42;
+
+  for (int threads : {1, 3}) {
+    config.nThreads = threads;
+    Metaheuristics<GRASPLocalSearch> first(&problem, config);
+    Metaheuristics<GRASPLocalSearch> second(&problem, config);
+
+    SFPSolution a = first.solve();
+    SFPSolution b = second.solve();
+
+    assert(a.isFeasible() && b.isFeasible());
+    assert(a.getCurrentCost() == b.getCurrentCost());
+    assert(first.getFirstCost() == second.getFirstCost());
+  }
+
+  std::cout << " -> Passed." << std::endl;
+}
+
+/**
+ * @brief Test 2: The parallel mode never returns something worse than its first restart.
+ */
+static void testParallelRestarts() {
+  std::cout << "[Test] Parallel Restarts...";
+
+  SFPProblem problem = makeGridProblem(10);
+
+  SolverConfig config;
+  config.maxIterations = 16;
+  config.alpha = 0.8f;
+  config.nThreads = 4;
+  config.seed = 7;
+
+  Metaheuristics<HubBreakingLocalSearch> solver(&problem, config);
+  SFPSolution best = solver.solve();
+
+  assert(best.isFeasible());
+  assert(best.getCurrentCost() <= solver.getFirstCost());
+
+  std::cout << " -> Passed." << std::endl;
+}
+
+/**
+ * @brief Test 3: The lazy candidate list must build the same solution as the eager one.
+ */
+static void testLazyCandidateList() {
+  std::cout << "[Test] Lazy Candidate List == Eager...";
+
+  SFPProblem problem = makeGridProblem(20, 60);
+
+  for (unsigned int seed = 1; seed <= 6; ++seed)
+    for (float alpha : {0.0f, 0.5f, 1.0f}) {
+      std::mt19937 rngEager(seed), rngLazy(seed);
+      GRASPConstructiveHeuristic eager(rngEager, nullptr, alpha, false);
+      GRASPConstructiveHeuristic lazy(rngLazy, nullptr, alpha, true);
+
+      SFPSolution a = eager.generate(&problem);
+      SFPSolution b = lazy.generate(&problem);
+
+      assert(a.getCurrentCost() == b.getCurrentCost());
+      assert(a.getNPairs() == b.getNPairs());
+      for (int p = 0; p < a.getNPairs(); ++p)
+        assert(*a.getPairEdges(p) == *b.getPairEdges(p));
+
+      // Rebuilding into a used solution gives the same result
+      rngLazy.seed(seed);
+      lazy.generateInto(&problem, a);
+      assert(a.getCurrentCost() == b.getCurrentCost());
+      for (int p = 0; p < a.getNPairs(); ++p)
+        assert(*a.getPairEdges(p) == *b.getPairEdges(p));
+    }
+
+  std::cout << " -> Passed." << std::endl;
+}
+
+/**
+ * @brief Test 4: Parallel move evaluation must follow the serial local search.
+ */
+static void testParallelLocalSearch() {
+  std::cout << "[Test] Parallel Local Search == Serial...";
+
+  SFPProblem problem = makeGridProblem(16, 40);
+
+  for (unsigned int seed = 1; seed <= 4; ++seed) {
+    std::mt19937 rng(seed);
+    GRASPConstructiveHeuristic constructive(rng, nullptr, 0.7f);
+    SFPSolution start = constructive.generate(&problem);
+
+    SFPSolution serial = start, parallel = start;
+    GRASPLocalSearch serialSearch(nullptr, 1);
+    GRASPLocalSearch parallelSearch(nullptr, 4);
+
+    bool moreSerial = true, moreParallel = true;
+    while (moreSerial || moreParallel) {
+      moreSerial = serialSearch.optimize(&serial);
+      moreParallel = parallelSearch.optimize(&parallel);
+      assert(moreSerial == moreParallel);
+      assert(serial.getCurrentCost() == parallel.getCurrentCost());
+    }
+
+    assert(parallel.isFeasible());
+    assert(parallel.getCurrentCost() <= start.getCurrentCost());
+    for (int p = 0; p < serial.getNPairs(); ++p)
+      assert(*serial.getPairEdges(p) == *parallel.getPairEdges(p));
+  }
+
+  std::cout << " -> Passed." << std::endl;
+}
+
+/**
+ * @brief Test 5: Bounded repairs keep the local searches consistent.
+ */
+static void testBoundedRepair() {
+  std::cout << "[Test] Bounded Repair Local Search...";
+
+  SFPProblem problem = makeGridProblem(16, 40);
+
+  for (unsigned int seed = 1; seed <= 4; ++seed) {
+    std::mt19937 rng(seed);
+    GRASPConstructiveHeuristic constructive(rng, nullptr, 0.7f);
+    SFPSolution start = constructive.generate(&problem);
+
+    SFPSolution grasp = start, hub = start;
+    GRASPLocalSearch graspSearch(nullptr, 1, QueueKind::AUTO, true);
+    HubBreakingLocalSearch hubSearch(nullptr, true);
+    while (graspSearch.optimize(&grasp));
+    while (hubSearch.optimize(&hub));
+
+    // Accepted moves strictly improve and the bookkeeping stays consistent
+    for (const SFPSolution* sol : {&grasp, &hub}) {
+      assert(sol->isFeasible());
+      assert(sol->getCurrentCost() <= start.getCurrentCost());
+      double cost = 0.0;
+      for (const auto& edge : *sol->getEdges()) cost += edge.weight;
+      assert(std::abs(cost - sol->getCurrentCost()) < 1e-6);
+    }
+  }
+
+  std::cout << " -> Passed." << std::endl;
+}
+
+/**
+ * @brief Test 6: Warm starts reinstall valid paths and repair the rest.
+ */
+static void testWarmStart() {
+  std::cout << "[Test] Warm Start...";
+
+  SFPProblem problem = makeGridProblem(10);
+  SolverConfig config;
+  config.maxIterations = 4;
+  config.alpha = 0.5f;
+  config.seed = 7;
+  SFPSolution best = Metaheuristics<GRASPLocalSearch>(&problem, config).solve();
+  auto snapshot = std::make_shared<SFPSnapshot>();
+  snapshot->capture(best);
+
+  // Same problem: every path is kept as it is
+  WarmStartHeuristic warm(snapshot);
+  SFPSolution same = warm.generate(&problem);
+  assert(warm.getKeptPaths() == best.getNPairs() && warm.getRepairedPaths() == 0);
+  assert(same.getCurrentCost() == best.getCurrentCost());
+
+  // New terminal pairs are connected by repairs
+  SFPProblem grown = makeGridProblem(10, 6);
+  SFPSolution extended = warm.generate(&grown);
+  assert(extended.isFeasible());
+  assert(warm.getKeptPaths() == best.getNPairs() && warm.getRepairedPaths() > 0);
+
+  // An edge of the first path disappears: only the pairs using it are rerouted
+  const Graph& graph = *problem.getGraphPtr();
+  int removed = best.getPairEdges(0)->front();
+  std::vector<std::tuple<int, int, float>> edgeList;
+  for (int i = 0; i < graph.nEdges; ++i)
+    if (i < graph.rev[i] && i != removed && graph.rev[i] != removed)
+      edgeList.push_back({graph.edges[i].source, graph.edges[i].target, graph.weights[i]});
+  SFPProblem pruned(std::make_shared<Graph>(edgeList, graph.nNodes), problem.getTerminals());
+
+  std::string path = (std::filesystem::temp_directory_path() / "sfp_test_warm.sol").string();
+  snapshot->save(path, problem);
+  auto loaded = std::make_shared<SFPSnapshot>();
+  loaded->load(path, pruned);
+  std::filesystem::remove(path);
+
+  SolverConfig warmConfig = config;
+  warmConfig.maxIterations = 1;
+  warmConfig.warmStart = loaded;
+  Metaheuristics<HubBreakingLocalSearch> solver(&pruned, warmConfig);
+  SFPSolution repaired = solver.solve();
+  assert(repaired.isFeasible());
+  assert(repaired.getCurrentCost() <= solver.getFirstCost());
+
+  WarmStartHeuristic rebuild(loaded);
+  rebuild.generate(&pruned);
+  int users = best.getEdgePairs(removed)->size();
+  assert(rebuild.getRepairedPaths() == users);
+  assert(rebuild.getKeptPaths() == best.getNPairs() - users);
+
+  std::cout << " -> Passed." << std::endl;
+}
+
+/**
+ * @brief Test 7: Time limit, target cost and incumbent reports.
+ */
+static void testAnytimeStops() {
+  std::cout << "[Test] Anytime Stopping Rules...";
+
+  SFPProblem problem = makeGridProblem(12, 10);
+  SolverConfig config;
+  config.maxIterations = 1000000;
+  config.alpha = 0.6f;
+  config.seed = 11;
+
+  // Any solution reaches an infinite target: one restart is enough
+  std::vector<Incumbent> seen;
+  config.targetCost = std::numeric_limits<double>::infinity();
+  config.onIncumbent = [&](const Incumbent& incumbent) {
+    assert(incumbent.solution->getCurrentCost() == incumbent.cost);
+    seen.push_back(incumbent);
+  };
+  SFPSolution first = Metaheuristics<GRASPLocalSearch>(&problem, config).solve();
+  assert(first.isFeasible());
+  assert(seen.size() == 1 && seen[0].iteration == 0 && seen[0].cost == first.getCurrentCost());
+
+  // The deadline interrupts an endless run, incumbents only get better
+  seen.clear();
+  config.targetCost = -std::numeric_limits<double>::infinity();
+  config.timeLimitMs = 50.0;
+  for (int threads : {1, 2}) {
+    config.nThreads = threads;
+    auto start = std::chrono::steady_clock::now();
+    SFPSolution best = Metaheuristics<HubBreakingLocalSearch>(&problem, config).solve();
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    assert(ms < 4.0 * config.timeLimitMs);
+    assert(best.isFeasible());
+    for (size_t k = 1; k < seen.size(); ++k) assert(seen[k].cost < seen[k - 1].cost);
+    assert(!seen.empty() && seen.back().cost == best.getCurrentCost());
+    seen.clear();
+  }
+
+  // Passes poll the stop rule between moves, whatever their length
+  SFPProblem large = makeGridProblem(40, 120);
+  std::mt19937 rng(5);
+  GRASPConstructiveHeuristic constructive(rng, nullptr, 0.7f);
+  const SFPSolution start = constructive.generate(&large);
+  GRASPLocalSearch graspSearch;
+  HubBreakingLocalSearch hubSearch;
+  for (LocalSearchStrategy* search : {static_cast<LocalSearchStrategy*>(&graspSearch),
+                                      static_cast<LocalSearchStrategy*>(&hubSearch)}) {
+    SFPSolution solution = start;
+    int polls = 0;
+    bool improved = search->optimize(&solution, [&] { return ++polls >= 1; });
+    assert(!improved && polls == 1 && solution.getCurrentCost() == start.getCurrentCost());
+
+    polls = 0;
+    search->optimize(&solution, [&] { return ++polls >= 3; });
+    assert(polls == 3 && solution.isFeasible());
+  }
+
+  // A deadline far shorter than one pass (seconds in debug builds) still
+  // holds. The warm start keeps the uninterruptible first construction short.
+  auto snapshot = std::make_shared<SFPSnapshot>();
+  snapshot->capture(start);
+  SolverConfig warm;
+  warm.maxIterations = 1000000;
+  warm.seed = 11;
+  warm.warmStart = snapshot;
+  warm.timeLimitMs = 100.0;
+  Metaheuristics<GRASPLocalSearch> solver(&large, warm);
+  auto begin = std::chrono::steady_clock::now();
+  SFPSolution cut = solver.solve();
+  double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+  assert(cut.isFeasible() && cut.getCurrentCost() <= start.getCurrentCost());
+  assert(ms < 3.0 * warm.timeLimitMs);
+
+  std::cout << " -> Passed." << std::endl;
+}
+
+/**
+ * @brief Test 8: Batch jobs reproduce single runs, broken instances are reported.
+ */
+static void testBatchRunner() {
+  std::cout << "[Test] Batch Runner...";
+
+  namespace fs = std::filesystem;
+  const fs::path dir = fs::temp_directory_path() / "sfp_test_batch";
+  fs::create_directories(dir);
+  {
+    std::ofstream good(dir / "square.stp");
+    good << "SECTION Graph\nNodes 4\nEdges 5\nE 1 2 1\nE 2 3 2\nE 3 4 3\nE 4 1 4\nE 1 3 2.5\nEND\n"
+            "SECTION Terminals\nTerminals 2\nTP 1 3\nTP 2 3\nEND\n";
+    std::ofstream bad(dir / "broken.stp");
+    bad << "SECTION Graph\nNodes 4\nEdges 1\nE 1 9 1\nEND\n";
+    std::ofstream manifest(dir / "manifest.txt");
+    manifest << "# relative to the manifest\nsquare.stp\n\n  broken.stp  \n";
+  }
+
+  auto listed = BatchRunner::listInstances((dir / "manifest.txt").string());
+  assert(listed.size() == 2 && fs::path(listed[0]).filename() == "square.stp");
+  assert(BatchRunner::listInstances(dir.string()).size() == 2);
+
+  // Jobs of an instance reuse the engines and landmarks of the finished ones
+  SolverConfig config;
+  config.maxIterations = 3;
+  config.alpha = 0.5f;
+  config.nLandmarks = 2;
+  std::vector<BatchResult> results;
+  BatchRunner(config, 2).run(listed, {"GRASP", "HUB"}, {5, 6, 7},
+                             [&](const BatchResult& result) { results.push_back(result); });
+  assert(results.size() == 12);
+
+  SFPProblem square;
+  square.loadFile(listed[0]);
+  for (const auto& result : results) {
+    if (fs::path(result.instance).filename() == "broken.stp") {
+      assert(!result.error.empty());
+      continue;
+    }
+    assert(result.error.empty() && result.feasible);
+    config.seed = result.seed;
+    double single = result.algorithm == "GRASP"
+                        ? Metaheuristics<GRASPLocalSearch>(&square, config).solve().getCurrentCost()
+                        : Metaheuristics<HubBreakingLocalSearch>(&square, config).solve().getCurrentCost();
+    assert(result.cost == single);
+  }
+  fs::remove_all(dir);
+
+  // Control characters of messages are escaped, JSON lines stay valid
+  BatchResult odd;
+  odd.instance = "a\"b\\c";
+  odd.error = "line\r\nend\x01\x1f";
+  std::ostringstream json;
+  BatchRunner::writeJSON(json, odd);
+  const std::string line = json.str();
+  assert(line.find("a\\\"b\\\\c") != std::string::npos);
+  assert(line.find("line\\r\\nend\\u0001\\u001f") != std::string::npos);
+  assert(std::none_of(line.begin(), line.end() - 1,
+                      [](char c) { return static_cast<unsigned char>(c) < 0x20; }));
+
+  std::cout << " -> Passed." << std::endl;
+}
+
+/**
+ * @brief Test 9: The shared path cache answers restarts without changing them.
+ */
+static void testPathCache() {
+  std::cout << "[Test] Shared Path Cache...";
+
+  SFPProblem problem = makeGridProblem(16, 40);
+  auto cache = std::make_shared<ShortestPathCache>();
+
+  for (float alpha : {0.3f, 1.0f}) {
+    std::mt19937 rngPlain(11), rngCached(11);
+    GRASPConstructiveHeuristic plain(rngPlain, nullptr, alpha);
+    GRASPConstructiveHeuristic cached(rngCached, nullptr, alpha, true, QueueKind::AUTO, cache);
+
+    // Later restarts are served by the cache
+    for (int restart = 0; restart < 4; ++restart) {
+      SFPSolution a = plain.generate(&problem);
+      SFPSolution b = cached.generate(&problem);
+      assert(a.getCurrentCost() == b.getCurrentCost());
+      for (int p = 0; p < a.getNPairs(); ++p)
+        assert(*a.getPairEdges(p) == *b.getPairEdges(p));
+    }
+  }
+  assert(cache->size() > 0);
+
+  // A spent budget stores nothing, and the answers stay the same
+  ShortestPathCache tiny(1);
+  tiny.storePath(0, 5, {{1, 2, 3}, 3.0f});
+  tiny.storeCost(0, 5, 3.0f);
+  float cost;
+  std::pair<std::vector<int>, float> path;
+  assert(!tiny.findPath(0, 5, path) && tiny.findCost(0, 5, cost) && cost == 3.0f);
+  tiny.storeCost(0, 6, 4.0f);
+  assert(!tiny.findCost(0, 6, cost) && tiny.size() == 1);
+
+  // Caching on or off, the runs are the same
+  SolverConfig config;
+  config.maxIterations = 6;
+  config.seed = 5;
+  SolverConfig uncached = config;
+  uncached.pathCacheEdges = 0;
+  SFPSolution on = Metaheuristics<GRASPLocalSearch>(&problem, config).solve();
+  SFPSolution off = Metaheuristics<GRASPLocalSearch>(&problem, uncached).solve();
+  assert(on.getCurrentCost() == off.getCurrentCost());
+
+  std::cout << " -> Passed." << std::endl;
+}
+
+/**
+ * @brief Test 10: Elite pool rules and path relinking toward a guide.
+ */
+static void testPathRelinking() {
+  std::cout << "[Test] Elite Pool & Path Relinking...";
+
+  SFPProblem problem = makeGridProblem(16, 40);
+  const Graph& graph = *problem.getGraphPtr();
+  std::mt19937 rng(3);
+  GRASPConstructiveHeuristic constructive(rng, nullptr, 1.0f);
+
+  std::vector<SFPSolution> optima;
+  GRASPLocalSearch search;
+  for (int k = 0; k < 6; ++k) {
+    optima.push_back(constructive.generate(&problem));
+    while (search.optimize(&optima.back()));
+  }
+
+  // Sorted, bounded, no duplicate edge sets
+  EliteSet elite(3);
+  for (const auto& solution : optima) elite.offer(solution);
+  assert(elite.size() == 3);
+  int best = 0;
+  for (int k = 1; k < static_cast<int>(optima.size()); ++k)
+    if (optima[k].getCurrentCost() < optima[best].getCurrentCost()) best = k;
+  assert(elite.bestCost() == optima[best].getCurrentCost());
+  assert(!elite.offer(optima[best]) && elite.size() == 3);
+  assert(EliteSet::distance({1, 2, 3}, {2, 3, 4, 5}) == 3);
+
+  // Relinking ends on the cheapest solution met, feasible and made of both
+  SFPSnapshot guide;
+  std::mt19937 pickRng(1);
+  assert(elite.pickGuide(optima[0], pickRng, guide));
+  std::vector<bool> known(graph.nEdges, false);
+  for (const auto& edge : *optima[0].getEdges()) known[edge.id] = true;
+  for (int e : guide.edges) known[e] = true;
+
+  SFPSolution walked = optima[0];
+  PathRelinking relinking;
+  int steps = relinking.relink(walked, guide);
+  assert(steps > 0);
+  assert(walked.isFeasible());
+  for (const auto& edge : *walked.getEdges()) assert(known[edge.id]);
+
+  // A guide with the same edges leaves the solution alone
+  SFPSnapshot self;
+  self.capture(walked);
+  double cost = walked.getCurrentCost();
+  assert(relinking.relink(walked, self) == 0 && walked.getCurrentCost() == cost);
+
+  // Single-threaded runs with an elite pool stay reproducible
+  SolverConfig config;
+  config.maxIterations = 8;
+  config.seed = 9;
+  config.eliteSize = 3;
+  config.relinkPeriod = 2;
+  SFPSolution a = Metaheuristics<HubBreakingLocalSearch>(&problem, config).solve();
+  SFPSolution b = Metaheuristics<HubBreakingLocalSearch>(&problem, config).solve();
+  assert(a.isFeasible() && a.getCurrentCost() == b.getCurrentCost());
+
+  std::cout << " -> Passed." << std::endl;
+}
+
+/**
+ * @brief Test 11: Service jobs match direct runs, stream progress and can be cancelled.
+ */
+static void testSolverService() {
+  std::cout << "[Test] Asynchronous Solver Service...";
+
+  auto problem = std::make_shared<const SFPProblem>(makeGridProblem(10, 6));
+  SolverConfig config;
+  config.maxIterations = 6;
+  config.alpha = 0.5f;
+  config.seed = 21;
+  config.nLandmarks = 4;
+  SFPSolution direct = Metaheuristics<HubBreakingLocalSearch>(problem.get(), config).solve();
+
+  SolverService service(2);
+  bool threw = false;
+  try {
+    service.submit(problem, "SIMPLEX", config);
+  } catch (const std::runtime_error&) {
+    threw = true;
+  }
+  assert(threw);
+
+  // The second job runs on the warm state of the first one
+  std::vector<Progress> progress;
+  config.onProgress = [&](const Progress& p) { progress.push_back(p); };
+  for (int run = 0; run < 2; ++run) {
+    progress.clear();
+    const ServiceResult& result = service.submit(problem, "HUB", config).result();
+    assert(result.status == JobStatus::DONE && result.error.empty());
+    assert(result.solution && result.solution->getCurrentCost() == direct.getCurrentCost());
+    assert(static_cast<int>(progress.size()) == config.maxIterations);
+    assert(progress.back().completed == config.maxIterations && progress.back().bestCost == direct.getCurrentCost());
+    assert(service.warmInstances() == 1);
+  }
+  config.onProgress = nullptr;
+
+  // An endless job stops on cancel with its incumbent, a queued one never starts
+  SolverService single(1);
+  std::atomic<bool> found(false);
+  config.maxIterations = 1000000;
+  config.onIncumbent = [&](const Incumbent&) { found = true; };
+  auto endless = single.submit(problem, "GRASP", config);
+  config.onIncumbent = nullptr;
+  auto queued = single.submit(problem, "HUB", config);
+  while (!found) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  assert(!endless.waitFor(1.0) && endless.status() == JobStatus::RUNNING);
+  // The queued job finishes at once, not behind the running one
+  queued.cancel();
+  assert(queued.waitFor(0.0) && queued.status() == JobStatus::CANCELLED && !queued.result().solution);
+  assert(endless.status() == JobStatus::RUNNING);
+  endless.cancel();
+  assert(endless.result().status == JobStatus::CANCELLED && endless.result().solution->isFeasible());
+  assert(queued.result().status == JobStatus::CANCELLED);
+
+  SolverService::Handle empty;
+  threw = false;
+  try {
+    empty.status();
+  } catch (const std::runtime_error&) {
+    threw = true;
+  }
+  assert(!empty.valid() && threw && endless.valid());
+
+  service.forget(problem.get());
+  assert(service.warmInstances() == 0);
+
+  std::cout << " -> Passed." << std::endl;
+}
+
+/**
+ * @brief Test 12: The hub set follows insert/erase, hub passes honor their cutoffs.
+ */
+static void testHubIndex() {
+  std::cout << "[Test] Incremental Hub Index...";
+
+  SFPProblem problem = makeGridProblem(14, 30);
+  const Graph& graph = *problem.getGraphPtr();
+  auto checkHubs = [&](const SFPSolution& solution) {
+    std::vector<int> degree(problem.getNNodes(), 0);
+    for (const auto& edge : *solution.getEdges()) {
+      degree[graph.edges[edge.id].source]++;
+      degree[graph.edges[edge.id].target]++;
+    }
+    std::vector<int> expected, hubs = *solution.getHubs();
+    for (int x = 0; x < problem.getNNodes(); ++x) {
+      assert(solution.getActiveDegree(x) == degree[x]);
+      if (degree[x] >= 3) expected.push_back(x);
+    }
+    std::sort(hubs.begin(), hubs.end());
+    assert(hubs == expected);
+  };
+
+  for (unsigned int seed = 1; seed <= 3; ++seed) {
+    std::mt19937 rng(seed);
+    GRASPConstructiveHeuristic constructive(rng, nullptr, 0.6f);
+    SFPSolution start = constructive.generate(&problem);
+    checkHubs(start);
+
+    for (auto [topK, first] : {std::pair<int, bool>{0, false}, {1, false}, {0, true}}) {
+      SFPSolution solution = start;
+      HubBreakingLocalSearch search(nullptr, false, topK, first);
+      while (search.optimize(&solution)) checkHubs(solution);
+      checkHubs(solution);
+      assert(solution.isFeasible() && solution.getCurrentCost() <= start.getCurrentCost());
+    }
+
+    start.reset();
+    checkHubs(start);
+    assert(start.getHubs()->empty());
+  }
+
+  std::cout << " -> Passed." << std::endl;
+}
+
+void solverTests() {
+  std::cout << std::endl;
+  std::cout << "========================================" << std::endl;
+  std::cout << "        STARTING SOLVER TEST SUITE      " << std::endl;
+  std::cout << "========================================" << std::endl;
+
+  testReproducibleRuns();
+  testParallelRestarts();
+  testLazyCandidateList();
+  testParallelLocalSearch();
+  testBoundedRepair();
+  testWarmStart();
+  testAnytimeStops();
+  testBatchRunner();
+  testPathCache();
+  testPathRelinking();
+  testSolverService();
+  testHubIndex();
+
+  std::cout << "========================================" << std::endl;
+  std::cout << "    ALL SOLVER TESTS PASSED SUCCESSFULLY" << std::endl;
+  std::cout << "========================================" << std::endl;
+}
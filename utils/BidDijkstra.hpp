@@ -7,122 +7,261 @@
 #include <memory>
 #include <limits>
 
+#include "EdgeMask.hpp"
 #include "Graph.hpp"
+#include "Landmarks.hpp"
+#include "PriorityQueue.hpp"
+#include "Stats.hpp"
 
 /**
  * @class BidirectionalDijkstraEngine
+ * @brief Interface of the bidirectional engine. Instances come from
+ * create(), which picks the priority queue policy.
  */
 class BidirectionalDijkstraEngine {
+ public:
+  virtual ~BidirectionalDijkstraEngine() = default;
+
+  /**
+   * @brief Computes the shortest path bidirectionally between source and target.
+   * @param state Optional per-edge EdgeState flags (bridges cost 0, ditchs
+   * are ignored).
+   * @param maxHops Hop limit of each frontier. -1 disables the limit.
+   * @param maxCost Only paths cheaper than it are returned; the frontiers
+   * stop growing at that radius. Infinity disables the limit.
+   */
+  virtual std::pair<std::vector<int>, float> getShortPath(
+      const int source, const int target,
+      const EdgeMask* state = nullptr,
+      const int maxHops = -1,
+      const float maxCost = std::numeric_limits<float>::infinity()) = 0;
+
+  /**
+   * @brief Whether the last getShortPath() left nodes unexpanded because of
+   * maxHops, i.e. a failed search might succeed with a wider limit.
+   */
+  virtual bool hopLimitReached() const = 0;
+
+  /// Bytes held by the engine (labels, stamps and queues)
+  virtual size_t memoryBytes() const = 0;
+
+  /**
+   * @param graph The reference graph
+   * @param landmarks Optional ALT tables built for the same graph
+   * @param queue Priority queue policy of both frontiers
+   */
+  static std::shared_ptr<BidirectionalDijkstraEngine> create(
+      const std::shared_ptr<Graph> graph,
+      std::shared_ptr<const Landmarks> landmarks = nullptr,
+      const QueueKind queue = QueueKind::AUTO);
+};
+
+/**
+ * @class BidirectionalDijkstraEngineImpl
+ * @brief Bidirectional Dijkstra with an optional ALT potential.
+ * * With landmarks, both searches use the average potential
+ * p(v) = (pi_t(v) - pi_s(v)) / 2, which keeps reduced costs non-negative in
+ * both directions, so the usual topF + topB >= best stopping rule still holds.
+ * The landmark bounds are taken on the original weights and are not valid
+ * once bridges zero some of them out, so queries with an edge state fall back
+ * to plain bidirectional Dijkstra.
+ * @tparam Queue Priority queue policy (see PriorityQueue.hpp).
+ */
+template <typename Queue>
+class BidirectionalDijkstraEngineImpl final : public BidirectionalDijkstraEngine {
  private:
   const std::shared_ptr<Graph> graph;
   
+  // Per-node labels: 12 bytes per direction, plus 4 with hop limits
   std::vector<float> distF;
-  std::vector<int> hopsCountF; 
-  std::vector<unsigned long long int> visitedTokenF;
-  std::vector<std::pair<int, int>> parentF;  
+  std::vector<int> hopsCountF;         ///< Allocated by the first hop-bounded query
+  std::vector<uint32_t> visitedTokenF;
+  std::vector<int> parentF;            ///< Edge reaching the node, its source is the parent
   
   std::vector<float> distB;
   std::vector<int> hopsCountB; 
-  std::vector<unsigned long long int> visitedTokenB;
-  std::vector<std::pair<int, int>> parentB;  
-
-  unsigned long long int currentToken;  
-
-  using Pii = std::pair<float, int>;
-  std::vector<Pii> pqF; 
-  std::vector<Pii> pqB;
+  std::vector<uint32_t> visitedTokenB;
+  std::vector<int> parentB;            ///< Edge u -> v that reached v from the target side
+
+  uint32_t currentToken;  
+  bool hopLimited;
+
+  Queue pqF; 
+  Queue pqB;
+
+  std::shared_ptr<const Landmarks> landmarks;
+  const float* sourceRow;
+  const float* targetRow;
+  std::vector<float> potential;
+  std::vector<uint32_t> potentialToken;
+
+  /// Starts a query; on wraparound every stamp is cleared so none can match
+  void nextToken() {
+    if (++currentToken != 0) return;
+    std::fill(visitedTokenF.begin(), visitedTokenF.end(), 0);
+    std::fill(visitedTokenB.begin(), visitedTokenB.end(), 0);
+    std::fill(potentialToken.begin(), potentialToken.end(), 0);
+    currentToken = 1;
+  }
 
-  inline float heuristic(int u, int v) const {
-      return (u + v) * 0.0f; // only for remove the warnings
+  /**
+   * @brief Forward potential of a node for the current query (0 without ALT).
+   */
+  template <bool kALT>
+  inline float heuristic(const int v) {
+      if constexpr (!kALT) {
+          return 0.0f;
+      } else {
+          if (potentialToken[v] != currentToken) {
+              potential[v] = 0.5f * (landmarks->lowerBound(v, targetRow) -
+                                     landmarks->lowerBound(v, sourceRow));
+              potentialToken[v] = currentToken;
+          }
+          return potential[v];
+      }
   }
 
  public:
   /**
    * @brief Constructor. Allocates frontier memory only once.
    * @param graph The reference graph
+   * @param landmarks Optional ALT tables built for the same graph
    */
-  BidirectionalDijkstraEngine(const std::shared_ptr<Graph> graph) 
-      : graph(graph), currentToken(0) {
+  BidirectionalDijkstraEngineImpl(const std::shared_ptr<Graph> graph,
+                                  std::shared_ptr<const Landmarks> landmarks = nullptr) 
+      : graph(graph), currentToken(0), hopLimited(false),
+        pqF(graph->nNodes, graph->nEdges / 2), pqB(graph->nNodes, graph->nEdges / 2),
+        landmarks(std::move(landmarks)),
+        sourceRow(nullptr), targetRow(nullptr) {
     int n = graph->nNodes;
     
     distF.resize(n);            distB.resize(n);
     parentF.resize(n);          parentB.resize(n);
     visitedTokenF.resize(n, 0); visitedTokenB.resize(n, 0);
-    hopsCountF.resize(n, 0);    hopsCountB.resize(n, 0);
-    
-    pqF.reserve(graph->nEdges / 2);
-    pqB.reserve(graph->nEdges / 2);
+
+    if (this->landmarks) {
+      potential.resize(n);
+      potentialToken.resize(n, 0);
+    }
   }
 
-  /**
-   * @brief Computes the shortest path bidirectionally between source and target.
-   */
   std::pair<std::vector<int>, float> getShortPath(
       const int source, const int target,
-      const std::vector<uint8_t>* bridges = nullptr,
-      const std::vector<uint8_t>* ditchs = nullptr,
-      const int maxHops = -1) { 
-      
+      const EdgeMask* state = nullptr,
+      const int maxHops = -1,
+      const float maxCost = std::numeric_limits<float>::infinity()) override { 
+    SFP_STAT_INC(BIDIJKSTRA_QUERIES);
+    SFP_STAT_TIMER(SHORTEST_PATH);
+    hopLimited = false;
     if (source == target) return {{}, 0.0f};
 
-    currentToken++;  
+    // One copy of the search per combination, without the checks it never needs
+    const bool hops = maxHops != -1;
+    if (hops && hopsCountF.empty()) {
+      hopsCountF.resize(graph->nNodes, 0);
+      hopsCountB.resize(graph->nNodes, 0);
+    }
+    if (state)
+      return hops ? search<true, true, false>(source, target, state, maxHops, maxCost)
+                  : search<true, false, false>(source, target, state, maxHops, maxCost);
+    if (landmarks)
+      return hops ? search<false, true, true>(source, target, state, maxHops, maxCost)
+                  : search<false, false, true>(source, target, state, maxHops, maxCost);
+    return hops ? search<false, true, false>(source, target, state, maxHops, maxCost)
+                : search<false, false, false>(source, target, state, maxHops, maxCost);
+  }
+
+  bool hopLimitReached() const override { return hopLimited; }
+
+  size_t memoryBytes() const override {
+    return sizeof(*this) + vectorBytes(distF) + vectorBytes(hopsCountF) + vectorBytes(visitedTokenF) +
+           vectorBytes(parentF) + vectorBytes(distB) + vectorBytes(hopsCountB) + vectorBytes(visitedTokenB) +
+           vectorBytes(parentB) + vectorBytes(potential) + vectorBytes(potentialToken) + pqF.memoryBytes() +
+           pqB.memoryBytes();
+  }
+
+ private:
+  /**
+   * @brief Search loop of getShortPath(). kState reads the edge state, kHops
+   * enforces maxHops (and only then counts hops), kALT adds the landmark
+   * potential; the dispatch picks them once per query.
+   */
+  template <bool kState, bool kHops, bool kALT>
+  std::pair<std::vector<int>, float> search(const int source, const int target,
+                                            const EdgeMask* state,
+                                            const int maxHops, const float maxCost) {
+    nextToken();
     pqF.clear(); pqB.clear();
 
+    if constexpr (kALT) {
+      sourceRow = landmarks->row(source);
+      targetRow = landmarks->row(target);
+    }
+
     // Forward Initialization
     distF[source] = 0.0f;
-    hopsCountF[source] = 0;
+    if constexpr (kHops) hopsCountF[source] = 0;
     visitedTokenF[source] = currentToken; 
-    parentF[source] = {-1, -1};
-    pqF.push_back({heuristic(source, target), source});
+    parentF[source] = -1;
+    pqF.push(heuristic<kALT>(source), source);
 
     // Backward Initialization
     distB[target] = 0.0f;
-    hopsCountB[target] = 0;
+    if constexpr (kHops) hopsCountB[target] = 0;
     visitedTokenB[target] = currentToken; 
-    parentB[target] = {-1, -1};
-    pqB.push_back({heuristic(target, source), target});
+    parentB[target] = -1;
+    pqB.push(-heuristic<kALT>(target), target);
 
-    float bestPathCost = std::numeric_limits<float>::infinity();
+    // The budget acts as an incumbent: the usual stopping rule prunes at it
+    float bestPathCost = maxCost;
     int meetingNode = -1;
 
-    const auto& ptrs = graph->ptrs;
-    const auto& edges = graph->edges;
+    const int* ptrs = graph->ptrs.data();
+    const int* targets = graph->targets.data();
+    const float* weights = graph->weights.data();
+    const uint64_t* mask = kState ? state->data() : nullptr;
+    const int* rev = graph->rev.data();
 
     while (!pqF.empty() && !pqB.empty()) {
         
-        float topF = pqF.front().first;
-        float topB = pqB.front().first;
+        float topF = pqF.topKey();
+        float topB = pqB.topKey();
         if (topF + topB >= bestPathCost) {
             break; 
         }
 
         // Expand the leaner frontier (Guarantees a smaller explored area)
         if (pqF.size() <= pqB.size()) {
-            std::pop_heap(pqF.begin(), pqF.end(), std::greater<Pii>());
-            float f_u = pqF.back().first;
-            int u = pqF.back().second;
-            pqF.pop_back();
+            auto [f_u, u] = pqF.pop();
 
             // Lazy discard (if a better path was found before processing)
-            if (distF[u] + heuristic(u, target) < f_u) continue;
-            if (maxHops != -1 && hopsCountF[u] >= maxHops) continue; 
+            if (distF[u] + heuristic<kALT>(u) < f_u) continue;
+            SFP_STAT_INC(SETTLED_NODES);
+            if (kHops && hopsCountF[u] >= maxHops) {
+                hopLimited = true;
+                continue;
+            }
 
             for (int i = ptrs[u]; i < ptrs[u + 1]; ++i) {
-                if (ditchs && (*ditchs)[i]) continue;
+                float edgeCost = weights[i];
+                if constexpr (kState) {
+                    const uint8_t flag = EdgeMask::get(mask, i);
+                    if (flag & EDGE_DITCH) continue;
+                    if (flag & EDGE_BRIDGE) edgeCost = 0.0f;
+                }
 
-                const auto& edge = edges[i];
-                int v = edge.target;
-                float edgeCost = (bridges && (*bridges)[i]) ? 0.0f : edge.weight;
+                int v = targets[i];
                 float newDist = distF[u] + edgeCost;
+                if (newDist >= maxCost) continue;
 
                 if (visitedTokenF[v] != currentToken || newDist < distF[v]) {
                     distF[v] = newDist;
-                    parentF[v] = {u, i}; // {Previous Node, Edge ID}
+                    parentF[v] = i;
                     visitedTokenF[v] = currentToken;
-                    hopsCountF[v] = hopsCountF[u] + 1;
+                    if constexpr (kHops) hopsCountF[v] = hopsCountF[u] + 1;
                     
-                    pqF.push_back({newDist + heuristic(v, target), v});
-                    std::push_heap(pqF.begin(), pqF.end(), std::greater<Pii>());
+                    pqF.push(newDist + heuristic<kALT>(v), v);
+                    SFP_STAT_INC(HEAP_PUSHES);
 
                     // Check for intersection with the Backward frontier
                     if (visitedTokenB[v] == currentToken) {
@@ -137,33 +276,40 @@ class BidirectionalDijkstraEngine {
         } 
         else {
             // Backward Expansion (Reverse trajectory)
-            std::pop_heap(pqB.begin(), pqB.end(), std::greater<Pii>());
-            float f_u = pqB.back().first;
-            int u = pqB.back().second;
-            pqB.pop_back();
+            auto [f_u, u] = pqB.pop();
 
-            if (distB[u] + heuristic(u, source) < f_u) continue;
-            if (maxHops != -1 && hopsCountB[u] >= maxHops) continue; 
+            if (distB[u] - heuristic<kALT>(u) < f_u) continue;
+            SFP_STAT_INC(SETTLED_NODES);
+            if (kHops && hopsCountB[u] >= maxHops) {
+                hopLimited = true;
+                continue;
+            }
 
             for (int i = ptrs[u]; i < ptrs[u + 1]; ++i) {
-                int rev_i = edges[i].reverseEdgePtr;
+                int rev_i = rev[i];
                 if (rev_i == -1) continue; // Safety check for edges without return
-                
-                // In backward, check ditchs/bridges on the original edge (v -> u)
-                if (ditchs && (*ditchs)[rev_i]) continue; 
 
-                int v = edges[i].target;
-                float edgeCost = (bridges && (*bridges)[rev_i]) ? 0.0f : edges[rev_i].weight;
+                // Twins share their weight; the state is read on the original
+                // edge (v -> u)
+                float edgeCost = weights[i];
+                if constexpr (kState) {
+                    const uint8_t flag = EdgeMask::get(mask, rev_i);
+                    if (flag & EDGE_DITCH) continue;
+                    if (flag & EDGE_BRIDGE) edgeCost = 0.0f;
+                }
+
+                int v = targets[i];
                 float newDist = distB[u] + edgeCost;
+                if (newDist >= maxCost) continue;
 
                 if (visitedTokenB[v] != currentToken || newDist < distB[v]) {
                     distB[v] = newDist;
-                    parentB[v] = {u, i}; // u explored v in backward via edge i (u->v)
+                    parentB[v] = i; // u explored v in backward via edge i (u->v)
                     visitedTokenB[v] = currentToken;
-                    hopsCountB[v] = hopsCountB[u] + 1;
+                    if constexpr (kHops) hopsCountB[v] = hopsCountB[u] + 1;
                     
-                    pqB.push_back({newDist + heuristic(v, source), v});
-                    std::push_heap(pqB.begin(), pqB.end(), std::greater<Pii>());
+                    pqB.push(newDist - heuristic<kALT>(v), v);
+                    SFP_STAT_INC(HEAP_PUSHES);
 
                     // Check for intersection with the Forward frontier
                     if (visitedTokenF[v] == currentToken) {
@@ -185,11 +331,12 @@ class BidirectionalDijkstraEngine {
     path.reserve(graph->nNodes / 10);  
 
     // Reconstruct the Forward part 
+    const Edge* edges = graph->edges.data();
     int curr = meetingNode;
     std::vector<int> pathF;
     while (curr != source) {
-        pathF.push_back(parentF[curr].second); 
-        curr = parentF[curr].first;
+        pathF.push_back(parentF[curr]); 
+        curr = edges[parentF[curr]].source;
     }
     std::reverse(pathF.begin(), pathF.end()); 
 
@@ -197,9 +344,9 @@ class BidirectionalDijkstraEngine {
     curr = meetingNode;
     std::vector<int> pathB;
     while (curr != target) {
-        int edgeIndex = parentB[curr].second; 
-        pathB.push_back(edges[edgeIndex].reverseEdgePtr); 
-        curr = parentB[curr].first;
+        int edgeIndex = parentB[curr]; 
+        pathB.push_back(rev[edgeIndex]); 
+        curr = edges[edgeIndex].source;
     }
 
     // Merge the two vectors
@@ -210,4 +357,17 @@ class BidirectionalDijkstraEngine {
   }
 };
 
+inline std::shared_ptr<BidirectionalDijkstraEngine> BidirectionalDijkstraEngine::create(
+    const std::shared_ptr<Graph> graph, std::shared_ptr<const Landmarks> landmarks,
+    const QueueKind queue) {
+  switch (resolveQueueKind(queue, *graph)) {
+    case QueueKind::QUATERNARY:
+      return std::make_shared<BidirectionalDijkstraEngineImpl<QuaternaryHeap>>(graph, std::move(landmarks));
+    case QueueKind::RADIX:
+      return std::make_shared<BidirectionalDijkstraEngineImpl<RadixHeap>>(graph, std::move(landmarks));
+    default:
+      return std::make_shared<BidirectionalDijkstraEngineImpl<BinaryHeap>>(graph, std::move(landmarks));
+  }
+}
+
 #endif
@@ -1,21 +1,22 @@
 #ifndef DSU_HPP
 #define DSU_HPP
 
-#include <numeric>
+#include <algorithm>
 #include <vector>
 
 /**
  * @struct DSU
  * @brief Optimized Disjoint Set Union (Union-Find) data structure.
- * * Implements the standard DSU with **Path Compression** and **Union by Rank**
- * optimizations. This structure is designed for high-performance connectivity
- * checks in the Steiner Forest Problem.
+ * * Implements the DSU with **Path Halving** and **Union by Size** in a single
+ * array: a node stores its parent, a root stores the negated size of its set.
+ * find() is iterative, so long chains cannot overflow the stack. This
+ * structure is designed for high-performance connectivity checks in the
+ * Steiner Forest Problem.
  * * @note The time complexity for operations is nearly constant, amortized
  * O(alpha(N)), where alpha is the inverse Ackermann function.
  */
 struct DSU {
-  std::vector<int> parent;  ///< Stores the immediate parent of each node.
-  std::vector<int> rank;    ///< Stores the immediate parent of each node.
+  std::vector<int> parent;  ///< Parent of each node, -(set size) for a root.
   int components;           ///< Tracks the current number of disjoint sets.
 
   /**
@@ -24,29 +25,31 @@ struct DSU {
    */
   explicit DSU(int nNodes) {
     parent.resize(nNodes);
-    rank.resize(nNodes);
     reset();
   }
 
   /**
    * @brief Resets the DSU to its initial state without reallocating memory.
-   * * Sets every node as its own parent and resets ranks.
+   * * Makes every node a root of size one.
    */
   void reset() {
-    std::iota(parent.begin(), parent.end(), 0);
-    std::fill(rank.begin(), rank.end(), 0);
+    std::fill(parent.begin(), parent.end(), -1);
     components = parent.size();
   }
 
   /**
    * @brief Finds the representative (root) of the set containing element i.
+   * * Every visited node is linked to its grandparent (path halving).
    * @param i The element to search for.
    * @return int The index of the root element.
    */
   int find(int i) {
-    if (parent[i] == i) return i;
-    // Path Compression assignment
-    return parent[i] = find(parent[i]);
+    while (parent[i] >= 0) {
+      int up = parent[i];
+      if (parent[up] < 0) return up;
+      i = parent[i] = parent[up];
+    }
+    return i;
   }
 
   /**
@@ -59,21 +62,14 @@ struct DSU {
   bool unite(int source, int target) {
     int root_source = find(source);
     int root_target = find(target);
+    if (root_source == root_target) return false;
 
-    if (root_source != root_target) {
-      // Union by Rank logic
-      if (rank[root_source] < rank[root_target]) {
-        parent[root_source] = root_target;
-      } else {
-        parent[root_target] = root_source;
-        if (rank[root_source] == rank[root_target]) {
-          rank[root_source]++;
-        }
-      }
-      components--;
-      return true;
-    }
-    return false;
+    // Union by Size: the larger set (more negative) keeps its root
+    if (parent[root_source] > parent[root_target]) std::swap(root_source, root_target);
+    parent[root_source] += parent[root_target];
+    parent[root_target] = root_source;
+    components--;
+    return true;
   }
 
   /**
@@ -86,6 +82,75 @@ struct DSU {
   bool isConnected(int source, int target) {
     return find(source) == find(target);
   }
+
+  /**
+   * @brief Number of elements in the set containing i.
+   */
+  int size(int i) { return -parent[find(i)]; }
+};
+
+/**
+ * @struct SparseDSU
+ * @brief DSU whose reset() is O(1), for queries that touch few nodes.
+ * * Uses the same token trick as the Dijkstra engines: a node is a singleton
+ * until its stamp matches the current epoch, so each query only pays for the
+ * nodes it unites. Same find/unite rules as DSU.
+ */
+struct SparseDSU {
+  std::vector<int> parent;            ///< Parent, or -(set size), of stamped nodes.
+  std::vector<unsigned int> stamp;    ///< Epoch in which each node was last touched.
+  unsigned int epoch;
+
+  explicit SparseDSU(int nNodes = 0) : epoch(1) { resize(nNodes); }
+
+  /**
+   * @brief Grows the node range, the current sets are kept.
+   */
+  void resize(int nNodes) {
+    if (nNodes <= static_cast<int>(parent.size())) return;
+    parent.resize(nNodes, -1);
+    stamp.resize(nNodes, 0);
+  }
+
+  /**
+   * @brief Makes every node a singleton again without touching the arrays.
+   */
+  void reset() {
+    if (++epoch == 0) {
+      std::fill(stamp.begin(), stamp.end(), 0);
+      epoch = 1;
+    }
+  }
+
+  int find(int i) {
+    if (stamp[i] != epoch) {
+      stamp[i] = epoch;
+      parent[i] = -1;
+      return i;
+    }
+    // Nodes above a stamped node were stamped when they were linked
+    while (parent[i] >= 0) {
+      int up = parent[i];
+      if (parent[up] < 0) return up;
+      i = parent[i] = parent[up];
+    }
+    return i;
+  }
+
+  bool unite(int source, int target) {
+    int root_source = find(source);
+    int root_target = find(target);
+    if (root_source == root_target) return false;
+
+    if (parent[root_source] > parent[root_target]) std::swap(root_source, root_target);
+    parent[root_source] += parent[root_target];
+    parent[root_target] = root_source;
+    return true;
+  }
+
+  bool isConnected(int source, int target) {
+    return source == target || find(source) == find(target);
+  }
 };
 
 #endif
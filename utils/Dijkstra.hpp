@@ -4,80 +4,187 @@
 #include <cstdint>
 #include <vector>
 #include <algorithm>
+#include <limits>
 #include <memory>
 
+#include "EdgeMask.hpp"
 #include "Graph.hpp"
+#include "PriorityQueue.hpp"
+#include "Stats.hpp"
 
 /**
  * @class DijkstraEngine
+ * @brief Interface of the unidirectional engine. Instances come from
+ * create(), which picks the priority queue policy.
+ */
+class DijkstraEngine {
+ public:
+  virtual ~DijkstraEngine() = default;
+
+  /**
+   * @brief Computes the shortest path between source and target.
+   * @param source The starting node ID.
+   * @param target The destination node ID.
+   * @param state Optional per-edge EdgeState flags (bridges cost 0, ditchs
+   * are ignored).
+   * @param maxHops Geodesic expansion limit. -1 disables the limit (Default).
+   * @return A pair containing the path and the cost.
+   */
+  virtual std::pair<std::vector<int>, float> getShortPath(
+      const int source, const int target,
+      const EdgeMask* state = nullptr,
+      const int maxHops = -1) = 0;
+
+  /**
+   * @brief One-to-many query: a single search from source that stops as soon
+   * as every target is settled.
+   * @param targets Destination node IDs (duplicates allowed).
+   * @param state Optional per-edge EdgeState flags.
+   * @param paths Optional output, the path to each target (empty when
+   * unreachable), edges listed from the target back to the source.
+   * @return The cost of each target, -1 when unreachable.
+   */
+  virtual std::vector<float> getShortPaths(const int source, const std::vector<int>& targets,
+                                           const EdgeMask* state = nullptr,
+                                           std::vector<std::vector<int>>* paths = nullptr) = 0;
+
+  /**
+   * @brief Multi-source expansion that labels every node within maxDist of
+   * the nearest source. Labels are read afterwards with getDistance().
+   * @param sources Nodes starting at distance 0.
+   * @param state Optional per-edge EdgeState flags.
+   * @param maxDist Radius of the expansion. Farther nodes stay unlabeled.
+   */
+  virtual void exploreFrom(const std::vector<int>& sources,
+                           const EdgeMask* state = nullptr,
+                           const float maxDist = std::numeric_limits<float>::infinity()) = 0;
+
+  /**
+   * @brief Label of a node after the last exploreFrom() call.
+   * @return The distance, or infinity if the node was not reached.
+   */
+  virtual float getDistance(const int node) const = 0;
+
+  /// Bytes held by the engine (labels, stamps and queue)
+  virtual size_t memoryBytes() const = 0;
+
+  static std::shared_ptr<DijkstraEngine> create(const std::shared_ptr<Graph> graph,
+                                                const QueueKind queue = QueueKind::AUTO);
+};
+
+/**
+ * @class DijkstraEngineImpl
  * @brief Helper class designed to execute Dijkstra's algorithm repeatedly with
  * high performance.
  * * This class uses persistent memory and a token-based system (Lazy Reset)
  * to avoid expensive O(N) memory allocations and initializations on every call.
  * * Updated with Hop-bounded (Spatially Delimited) execution capabilities.
+ * @tparam Queue Priority queue policy (see PriorityQueue.hpp).
  */
-class DijkstraEngine {
+template <typename Queue>
+class DijkstraEngineImpl final : public DijkstraEngine {
  private:
   const std::shared_ptr<Graph> graph;
   std::vector<float> dist;
-  std::vector<int> hopsCount; 
-  std::vector<unsigned long long int> visitedToken;
-  std::vector<std::pair<int, int>> parent;  
-  unsigned long long int currentToken;  
+  std::vector<int> hopsCount;            ///< Allocated by the first hop-bounded query
+  std::vector<uint32_t> visitedToken;
+  std::vector<int> parent;               ///< Edge reaching the node, its source is the parent
+  std::vector<uint32_t> targetToken;     ///< Pending targets of getShortPaths(), allocated by the first one
+  uint32_t currentToken;  
 
-  using Pii = std::pair<float, int>;
-  std::vector<Pii> pq;
+  Queue pq;
+
+  /// Starts a query; on wraparound every stamp is cleared so none can match
+  void nextToken() {
+    if (++currentToken != 0) return;
+    std::fill(visitedToken.begin(), visitedToken.end(), 0);
+    std::fill(targetToken.begin(), targetToken.end(), 0);
+    currentToken = 1;
+  }
 
  public:
   /**
    * @brief Constructor. Allocates memory once.
    * @param graph The reference graph
    */
-  DijkstraEngine(const std::shared_ptr<Graph> graph) : graph(graph), currentToken(0){
+  DijkstraEngineImpl(const std::shared_ptr<Graph> graph)
+      : graph(graph), currentToken(0), pq(graph->nNodes, graph->nEdges) {
     dist.resize(graph->nNodes);
     parent.resize(graph->nNodes);
     visitedToken.resize(graph->nNodes, 0);
-    hopsCount.resize(graph->nNodes, 0); 
-    pq.reserve(graph->nEdges);
   }
 
-  /**
-   * @brief Computes the shortest path between source and target.
-   * @param source The starting node ID.
-   * @param target The destination node ID.
-   * @param bridges Optional bitmask of edges with 0 cost.
-   * @param ditchs Optional bitmask of edges with infinite cost (ignored).
-   * @param maxHops Geodesic expansion limit. -1 disables the limit (Default).
-   * @return A pair containing the path and the cost.
-   */
   std::pair<std::vector<int>, float> getShortPath(
       const int source, const int target,
-      const std::vector<uint8_t>* bridges = nullptr,
-      const std::vector<uint8_t>* ditchs = nullptr,
-      const int maxHops = -1) { 
-      
-    currentToken++;  
+      const EdgeMask* state = nullptr,
+      const int maxHops = -1) override { 
+    SFP_STAT_INC(DIJKSTRA_QUERIES);
+    if (maxHops != -1 && hopsCount.empty()) hopsCount.resize(graph->nNodes, 0);
+    // One copy of each search per combination, without the checks it never needs
+    if (state)
+      return maxHops != -1 ? searchPath<true, true>(source, target, state, maxHops)
+                           : searchPath<true, false>(source, target, state, maxHops);
+    return maxHops != -1 ? searchPath<false, true>(source, target, state, maxHops)
+                         : searchPath<false, false>(source, target, state, maxHops);
+  }
+
+  std::vector<float> getShortPaths(const int source, const std::vector<int>& targets,
+                                   const EdgeMask* state = nullptr,
+                                   std::vector<std::vector<int>>* paths = nullptr) override {
+    SFP_STAT_INC(DIJKSTRA_QUERIES);
+    if (targetToken.empty()) targetToken.resize(graph->nNodes, 0);
+    return state ? searchTargets<true>(source, targets, state, paths)
+                 : searchTargets<false>(source, targets, state, paths);
+  }
+
+  void exploreFrom(const std::vector<int>& sources,
+                   const EdgeMask* state = nullptr,
+                   const float maxDist = std::numeric_limits<float>::infinity()) override {
+    SFP_STAT_INC(DIJKSTRA_QUERIES);
+    if (state) searchFrom<true>(sources, state, maxDist);
+    else searchFrom<false>(sources, state, maxDist);
+  }
+
+  size_t memoryBytes() const override {
+    return sizeof(*this) + vectorBytes(dist) + vectorBytes(hopsCount) + vectorBytes(visitedToken) +
+           vectorBytes(parent) + vectorBytes(targetToken) + pq.memoryBytes();
+  }
+
+  float getDistance(const int node) const override {
+    return visitedToken[node] == currentToken
+               ? dist[node]
+               : std::numeric_limits<float>::infinity();
+  }
+
+ private:
+  /// Loops of the queries above: kState reads the edge state, kHops enforces
+  /// maxHops and only then counts hops
+  template <bool kState, bool kHops>
+  std::pair<std::vector<int>, float> searchPath(const int source, const int target,
+                                                const EdgeMask* state,
+                                                const int maxHops) {
+    nextToken();
     
     pq.clear();
 
     dist[source] = 0.0f;
-    hopsCount[source] = 0;
+    if constexpr (kHops) hopsCount[source] = 0;
     visitedToken[source] = currentToken; 
-    parent[source] = {-1, -1};
-    pq.push_back({0.0f, source});
+    parent[source] = -1;
+    pq.push(0.0f, source);
 
-    const auto& ptrs = graph->ptrs;
-    const auto& edges = graph->edges;
+    const int* ptrs = graph->ptrs.data();
+    const int* targets = graph->targets.data();
+    const float* weights = graph->weights.data();
+    const uint64_t* mask = kState ? state->data() : nullptr;
 
     bool found = false;
 
     while (!pq.empty()) {
-      std::pop_heap(pq.begin(), pq.end(), std::greater<Pii>());
-      float d = pq.back().first;
-      int u = pq.back().second;
-      pq.pop_back();
+      auto [d, u] = pq.pop();
 
       if (visitedToken[u] == currentToken && d > dist[u]) continue;
+      SFP_STAT_INC(SETTLED_NODES);
 
       if (u == target) {
         found = true;
@@ -85,30 +192,29 @@ class DijkstraEngine {
       }
 
       // Ignore if the constraint is active (!= -1) and reach the radius limit, 
-      if (maxHops != -1 && hopsCount[u] >= maxHops) continue; 
+      if (kHops && hopsCount[u] >= maxHops) continue;
 
       for (int i = ptrs[u]; i < ptrs[u + 1]; ++i) {
-        if (ditchs && (*ditchs)[i]) continue;
+        float edgeCost = weights[i];
 
-        const auto& edge = edges[i];
-        float edgeCost = edge.weight;
-
-        if (bridges && (*bridges)[i]) {
-            edgeCost = 0.0f;
+        if constexpr (kState) {
+          const uint8_t flag = EdgeMask::get(mask, i);
+          if (flag & EDGE_DITCH) continue;
+          if (flag & EDGE_BRIDGE) edgeCost = 0.0f;
         }
 
-        int v = edge.target;
+        int v = targets[i];
         float newDist = d + edgeCost;
 
         bool isFirstVisit = (visitedToken[v] != currentToken);
 
         if (isFirstVisit || newDist < dist[v]) {
           dist[v] = newDist;
-          parent[v] = {u, i};
+          parent[v] = i;
           visitedToken[v] = currentToken;
-          hopsCount[v] = hopsCount[u] + 1;
-          pq.push_back({newDist, v});
-          std::push_heap(pq.begin(), pq.end(), std::greater<Pii>());
+          if constexpr (kHops) hopsCount[v] = hopsCount[u] + 1;
+          pq.push(newDist, v);
+          SFP_STAT_INC(HEAP_PUSHES);
         }
       }
     }
@@ -118,19 +224,151 @@ class DijkstraEngine {
     std::vector<int> path;
     path.reserve(graph->nNodes / 10);  
 
+    const Edge* edges = graph->edges.data();
     int curr = target;
-    while (curr != source && curr != -1) {
-      int node = parent[curr].first;
-      int edge = parent[curr].second;
+    while (curr != source && parent[curr] != -1) {
+      path.push_back(parent[curr]);
+      curr = edges[parent[curr]].source;
+    }
 
-      if (node == -1) break;
+    return {path, dist[target]};
+  }
+
+  template <bool kState>
+  std::vector<float> searchTargets(const int source, const std::vector<int>& targets,
+                                   const EdgeMask* state,
+                                   std::vector<std::vector<int>>* paths) {
+    nextToken();
+    pq.clear();
+
+    int pending = 0;
+    for (int t : targets)
+      if (targetToken[t] != currentToken) {
+        targetToken[t] = currentToken;
+        pending++;
+      }
+
+    dist[source] = 0.0f;
+    visitedToken[source] = currentToken;
+    parent[source] = -1;
+    pq.push(0.0f, source);
+
+    const int* ptrs = graph->ptrs.data();
+    const int* heads = graph->targets.data();
+    const float* weights = graph->weights.data();
+    const uint64_t* mask = kState ? state->data() : nullptr;
+
+    while (!pq.empty()) {
+      auto [d, u] = pq.pop();
+
+      if (d > dist[u]) continue;
+      SFP_STAT_INC(SETTLED_NODES);
+
+      // Settled: a target is cleared once, even if it is popped again
+      if (targetToken[u] == currentToken) {
+        targetToken[u] = 0;
+        if (--pending == 0) break;
+      }
 
-      path.push_back(edge);
-      curr = node;
+      for (int i = ptrs[u]; i < ptrs[u + 1]; ++i) {
+        float edgeCost = weights[i];
+
+        if constexpr (kState) {
+          const uint8_t flag = EdgeMask::get(mask, i);
+          if (flag & EDGE_DITCH) continue;
+          if (flag & EDGE_BRIDGE) edgeCost = 0.0f;
+        }
+
+        int v = heads[i];
+        float newDist = d + edgeCost;
+        if (visitedToken[v] != currentToken || newDist < dist[v]) {
+          dist[v] = newDist;
+          parent[v] = i;
+          visitedToken[v] = currentToken;
+          pq.push(newDist, v);
+          SFP_STAT_INC(HEAP_PUSHES);
+        }
+      }
     }
 
-    return {path, dist[target]};
+    // Targets still pending were never settled
+    std::vector<float> costs(targets.size(), -1.0f);
+    if (paths) paths->assign(targets.size(), {});
+    for (size_t k = 0; k < targets.size(); ++k) {
+      int t = targets[k];
+      if (visitedToken[t] != currentToken || targetToken[t] == currentToken) continue;
+      costs[k] = dist[t];
+      if (!paths) continue;
+      for (int curr = t; parent[curr] != -1; curr = graph->edges[parent[curr]].source)
+        (*paths)[k].push_back(parent[curr]);
+    }
+    return costs;
+  }
+
+  template <bool kState>
+  void searchFrom(const std::vector<int>& sources, const EdgeMask* state,
+                  const float maxDist) {
+    nextToken();
+    pq.clear();
+
+    for (int s : sources) {
+      if (visitedToken[s] == currentToken) continue;
+      dist[s] = 0.0f;
+      visitedToken[s] = currentToken;
+      parent[s] = -1;
+      pq.push(0.0f, s);
+    }
+
+    const int* ptrs = graph->ptrs.data();
+    const int* targets = graph->targets.data();
+    const float* weights = graph->weights.data();
+    const uint64_t* mask = kState ? state->data() : nullptr;
+
+    while (!pq.empty()) {
+      auto [d, u] = pq.pop();
+
+      if (d > dist[u]) continue;
+      SFP_STAT_INC(SETTLED_NODES);
+
+      for (int i = ptrs[u]; i < ptrs[u + 1]; ++i) {
+        float edgeCost = weights[i];
+
+        if constexpr (kState) {
+          const uint8_t flag = EdgeMask::get(mask, i);
+          if (flag & EDGE_DITCH) continue;
+          if (flag & EDGE_BRIDGE) edgeCost = 0.0f;
+        }
+
+        float newDist = d + edgeCost;
+        if (newDist > maxDist) continue;
+
+        int v = targets[i];
+        if (visitedToken[v] != currentToken || newDist < dist[v]) {
+          dist[v] = newDist;
+          parent[v] = i;
+          visitedToken[v] = currentToken;
+          pq.push(newDist, v);
+          SFP_STAT_INC(HEAP_PUSHES);
+        }
+      }
+    }
   }
 };
 
+/**
+ * @brief Builds an engine with the given queue policy (AUTO is resolved
+ * against the graph weights).
+ */
+inline std::shared_ptr<DijkstraEngine> DijkstraEngine::create(
+    const std::shared_ptr<Graph> graph, const QueueKind queue) {
+  switch (resolveQueueKind(queue, *graph)) {
+    case QueueKind::QUATERNARY:
+      return std::make_shared<DijkstraEngineImpl<QuaternaryHeap>>(graph);
+    case QueueKind::RADIX:
+      return std::make_shared<DijkstraEngineImpl<RadixHeap>>(graph);
+    default:
+      return std::make_shared<DijkstraEngineImpl<BinaryHeap>>(graph);
+  }
+}
+
 #endif
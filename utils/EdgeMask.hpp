@@ -0,0 +1,133 @@
+#ifndef EDGE_MASK_HPP
+#define EDGE_MASK_HPP
+
+#include <cstdint>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "Graph.hpp"
+
+/**
+ * @class EdgeMask
+ * @brief Bridge and ditch flags of every directed edge, 32 edges per word.
+ * * Each edge owns two adjacent bits laid out as its EdgeState (bit 0 bridge,
+ * bit 1 ditch), so get() is a single load, shift and mask, and the two planes
+ * are read apart with the kBridges/kDitches lane masks. That is 2 bits per
+ * edge instead of a byte. Bits past size() stay clear, so the bulk
+ * operations work on whole words. Pair setters take the reverse edge (-1 if
+ * none) and write both twins, as the engines expect.
+ */
+class EdgeMask {
+ private:
+  static constexpr uint64_t kBridges = 0x5555555555555555ULL;  ///< Bridge bit of every lane
+  static constexpr uint64_t kDitches = kBridges << 1;
+
+  std::vector<uint64_t> words;
+  int nEdges = 0;
+
+  static int popcount(const uint64_t word) {
+#ifdef _MSC_VER
+    return static_cast<int>(__popcnt64(word));
+#else
+    return __builtin_popcountll(word);
+#endif
+  }
+
+  static int shift(const int e) { return (e & 31) << 1; }
+
+ public:
+  EdgeMask() = default;
+  explicit EdgeMask(const int nEdges, const uint8_t state = EDGE_FREE) { assign(nEdges, state); }
+
+  /**
+   * @brief Resizes to `size` edges, all set to `state`. The capacity is kept.
+   */
+  void assign(const int size, const uint8_t state = EDGE_FREE) {
+    nEdges = size;
+    words.assign((size + 31) / 32, 0);
+    fill(state);
+  }
+
+  /// Sets every edge to `state`
+  void fill(const uint8_t state) {
+    const uint64_t pattern = ((state & EDGE_BRIDGE) ? kBridges : 0) | ((state & EDGE_DITCH) ? kDitches : 0);
+    for (auto& word : words) word = pattern;
+    const int rest = nEdges & 31;
+    if (rest && !words.empty()) words.back() &= (uint64_t{1} << (2 * rest)) - 1;
+  }
+
+  int size() const { return nEdges; }
+  size_t memoryBytes() const { return vectorBytes(words); }
+
+  /// EdgeState flags of an edge
+  uint8_t get(const int e) const { return get(words.data(), e); }
+
+  /// Same read on raw words, for loops that keep data() in a local
+  static uint8_t get(const uint64_t* words, const int e) {
+    return static_cast<uint8_t>((words[e >> 5] >> shift(e)) & 3);
+  }
+  const uint64_t* data() const { return words.data(); }
+
+  bool isBridge(const int e) const { return get(e) & EDGE_BRIDGE; }
+  bool isDitch(const int e) const { return get(e) & EDGE_DITCH; }
+
+  /// Writes the flags of one edge
+  void set(const int e, const uint8_t state) {
+    uint64_t& word = words[e >> 5];
+    word = (word & ~(uint64_t{3} << shift(e))) | (uint64_t{state & 3u} << shift(e));
+  }
+
+  /// Writes the flags of an edge and its reverse
+  void set(const int e, const int rev, const uint8_t state) {
+    set(e, state);
+    if (rev != -1) set(rev, state);
+  }
+
+  void setBridge(const int e, const int rev, const bool bridge) { setFlag(e, rev, EDGE_BRIDGE, bridge); }
+  void setDitch(const int e, const int rev, const bool ditch) { setFlag(e, rev, EDGE_DITCH, ditch); }
+
+  /// Sets or clears one flag of an edge and its reverse, the other is kept
+  void setFlag(const int e, const int rev, const uint8_t flag, const bool on) {
+    for (int id : {e, rev}) {
+      if (id == -1) continue;
+      const uint64_t bit = uint64_t{flag} << shift(id);
+      words[id >> 5] = on ? words[id >> 5] | bit : words[id >> 5] & ~bit;
+    }
+  }
+
+  /// Clears every ditch, bridges are kept
+  void clearDitches() {
+    for (auto& word : words) word &= kBridges;
+  }
+
+  /// Directed edges flagged as bridges (twins count twice)
+  int countBridges() const {
+    int count = 0;
+    for (uint64_t word : words) count += popcount(word & kBridges);
+    return count;
+  }
+
+  int countDitches() const {
+    int count = 0;
+    for (uint64_t word : words) count += popcount(word & kDitches);
+    return count;
+  }
+
+  /// Removes the bridges of `other` from this mask (same size)
+  void andNotBridges(const EdgeMask& other) {
+    for (size_t w = 0; w < words.size(); ++w) words[w] &= ~(other.words[w] & kBridges);
+  }
+
+  /// Ditches every bridge of `other` (same size), e.g. to forbid a forest
+  void ditchBridges(const EdgeMask& other) {
+    for (size_t w = 0; w < words.size(); ++w) words[w] |= (other.words[w] & kBridges) << 1;
+  }
+
+  bool operator==(const EdgeMask& other) const { return nEdges == other.nEdges && words == other.words; }
+  bool operator!=(const EdgeMask& other) const { return !(*this == other); }
+};
+
+#endif
@@ -2,11 +2,24 @@
 #define GRAPH_HPP
 
 #include <algorithm>
+#include <cstdint>
 #include <ostream>
 #include <queue>
 #include <stdexcept>
+#include <tuple>
+#include <utility>
 #include <vector>
 
+#include "Stats.hpp"
+
+/**
+ * @brief Heap bytes held by a vector (its capacity, not its size).
+ */
+template <typename T>
+inline size_t vectorBytes(const std::vector<T>& v) {
+  return v.capacity() * sizeof(T);
+}
+
 /**
  * @struct Edge
  * @brief Represents an edge from the graph.
@@ -20,6 +33,12 @@ struct Edge {
   float weight;        ///< The weight of this edge
 };
 
+/**
+ * @brief Flags of the packed per-edge state read by the shortest path engines.
+ * A bridge costs 0 and a ditch is ignored.
+ */
+enum EdgeState : uint8_t { EDGE_FREE = 0, EDGE_BRIDGE = 1, EDGE_DITCH = 2 };
+
 /**
  * @struct Graph
  * @brief Struct defining a graph to SFP using CSR (Compressed Sparse Row).
@@ -30,88 +49,150 @@ struct Graph {
   float totalWeight;         ///< The sum of all weight of this graph
   int nNodes, nEdges;  ///< the number of nodes and edges of this graph
 
+  // Structure-of-arrays view of `edges`, so a relaxation only touches the
+  // fields it reads. Indexed by edge id, filled by every constructor.
+  std::vector<int> targets;   ///< edges[i].target
+  std::vector<float> weights; ///< edges[i].weight
+  std::vector<int> rev;       ///< edges[i].reverseEdgePtr
+
   /**
    * @brief Construtor Raw Data -> CSR.
+   * * Two-pass counting sort: rows are written in place from the degree
+   * counts, sorted by target (parallel edges keep their input order), and
+   * every edge is linked to its own twin in O(1).
    * @param nNodes Number of nodes.
    * @param edgeList tuple vector {origin:int, target:int, weight:float}.
    */
   Graph(const std::vector<std::tuple<int, int, float>>& edgeList,
         const int nNodes)
       : totalWeight(0.0f), nNodes(nNodes), nEdges(edgeList.size() * 2) {
+    SFP_STAT_TIMER(GRAPH_BUILD);
     if (nNodes <= 0)
       throw std::runtime_error("\t\tNumber of nodes must be positive.");
     if (edgeList.empty())
       throw std::runtime_error("\t\tedgeList cannot be empty");
 
-    // Temporary Adjacency List
-    struct TempEdge {
-      int target;
-      float weight;
+    // Both directions of input edge k are the half-edges 2k (origin -> target)
+    // and 2k + 1 (target -> origin), so each one's twin is h ^ 1.
+    auto halfSource = [&](const int h) {
+      const auto& edge = edgeList[h >> 1];
+      return (h & 1) ? std::get<1>(edge) : std::get<0>(edge);
+    };
+    auto halfTarget = [&](const int h) {
+      const auto& edge = edgeList[h >> 1];
+      return (h & 1) ? std::get<0>(edge) : std::get<1>(edge);
     };
-    std::vector<std::vector<TempEdge>> adj(nNodes);
 
+    // Degree count: every node is the source and the target of deg(u) halves
+    ptrs.assign(nNodes + 1, 0);
     double tempTotalWeight = 0;
 
     for (const auto& edge : edgeList) {
       int origin = std::get<0>(edge);
       int target = std::get<1>(edge);
-      float weight = std::get<2>(edge);
 
       if (origin < 0 || origin >= nNodes || target < 0 || target >= nNodes)
         throw std::runtime_error("\t\tEdge index out of bounds.");
 
-      adj[origin].push_back({target, weight});
-      adj[target].push_back({origin, weight});
-      tempTotalWeight += weight;
+      ptrs[origin + 1]++;
+      ptrs[target + 1]++;
+      tempTotalWeight += std::get<2>(edge);
     }
+    for (int i = 0; i < nNodes; i++) ptrs[i + 1] += ptrs[i];
+    totalWeight = tempTotalWeight;
 
-    // Flattening to CSR
-    ptrs.reserve(nNodes + 1);
-    edges.reserve(nEdges);
-    ptrs.push_back(0);
-
-    for (int i = 0; i < nNodes; i++) {
-      // Sorting makes finding reverse edges deterministic and faster
-      std::sort(adj[i].begin(), adj[i].end(),
-                [](const TempEdge& a, const TempEdge& b) {
-                  return a.target < b.target;
-                });
-      // Initialize reverseEdgePtr to -1
-      for (const auto& edge : adj[i])
-        edges.push_back({i, edge.target, -1, edge.weight});
-      ptrs.push_back(edges.size());
-    }
+    // Pass 1: half-edges ordered by target (stable counting sort)
+    std::vector<int> order(nEdges);
+    std::vector<int> cursor(ptrs.begin(), ptrs.end() - 1);
+    for (int h = 0; h < nEdges; h++) order[cursor[halfTarget(h)]++] = h;
 
-    // Linking Reverse Edges
-    for (int i = 0; i < nEdges; i++) {
-      // Optimization: If already linked by its twin, skip
-      if (edges[i].reverseEdgePtr != -1) continue;
-
-      int source = edges[i].source;
-      int target = edges[i].target;
-
-      // Find the index of edge v -> u
-      for (int j = ptrs[target]; j < ptrs[target + 1]; ++j)
-        if (edges[j].target == source) {
-          edges[i].reverseEdgePtr = j;
-          edges[j].reverseEdgePtr = i;
-          break;
-        }
-      totalWeight = tempTotalWeight;
+    // Pass 2: distribute by source, so each row ends up sorted by target.
+    // reverseEdgePtr temporarily holds the half-edge id.
+    edges.resize(nEdges);
+    std::copy(ptrs.begin(), ptrs.end() - 1, cursor.begin());
+    for (int h : order) {
+      int pos = cursor[halfSource(h)]++;
+      edges[pos] = {halfSource(h), halfTarget(h), h, std::get<2>(edgeList[h >> 1])};
     }
+
+    // Linking Reverse Edges: position of every half-edge, then of its twin
+    for (int pos = 0; pos < nEdges; pos++) order[edges[pos].reverseEdgePtr] = pos;
+    for (auto& edge : edges) edge.reverseEdgePtr = order[edge.reverseEdgePtr ^ 1];
+
+    buildArrays();
   }
   
+  /**
+   * @brief Constructor from an already built CSR (e.g. a binary snapshot).
+   * @param ptrs CSR row pointers (nNodes + 1 entries).
+   * @param edges CSR edges with their reverse pointers resolved.
+   * @param totalWeight Sum of the weights of the undirected edges.
+   */
+  Graph(std::vector<int> ptrs, std::vector<Edge> edges, const float totalWeight)
+      : ptrs(std::move(ptrs)),
+        edges(std::move(edges)),
+        totalWeight(totalWeight),
+        nNodes(static_cast<int>(this->ptrs.size()) - 1),
+        nEdges(static_cast<int>(this->edges.size())) {
+    if (nNodes <= 0)
+      throw std::runtime_error("\t\tNumber of nodes must be positive.");
+    if (this->ptrs.front() != 0 || this->ptrs.back() != nEdges)
+      throw std::runtime_error("\t\tCSR row pointers do not match the edges.");
+
+    for (int u = 0; u < nNodes; ++u) {
+      if (this->ptrs[u] > this->ptrs[u + 1])
+        throw std::runtime_error("\t\tCSR row pointers must be non-decreasing.");
+
+      for (int i = this->ptrs[u]; i < this->ptrs[u + 1]; ++i) {
+        const Edge& e = this->edges[i];
+        if (e.source != u || e.target < 0 || e.target >= nNodes ||
+            e.reverseEdgePtr < -1 || e.reverseEdgePtr >= nEdges)
+          throw std::runtime_error("\t\tEdge index out of bounds.");
+
+        // The engines scan a backward edge with the weight of its twin
+        if (e.reverseEdgePtr == -1) continue;
+        const Edge& twin = this->edges[e.reverseEdgePtr];
+        if (twin.reverseEdgePtr != i || twin.source != e.target || twin.target != e.source ||
+            twin.weight != e.weight)
+          throw std::runtime_error("\t\tReverse edges are not mutual twins.");
+      }
+    }
+
+    buildArrays();
+  }
+
   // Deep copy of the Graph
   Graph(const Graph& other) 
       : ptrs(other.ptrs),
         edges(other.edges),
         totalWeight(other.totalWeight),
         nNodes(other.nNodes),
-        nEdges(other.nEdges) {}
+        nEdges(other.nEdges),
+        targets(other.targets),
+        weights(other.weights),
+        rev(other.rev) {}
+
+  /// Bytes of the CSR and of its structure-of-arrays view
+  size_t memoryBytes() const {
+    return sizeof(*this) + vectorBytes(ptrs) + vectorBytes(edges) + vectorBytes(targets) +
+           vectorBytes(weights) + vectorBytes(rev);
+  }
 
   // Delete Copy/Assignment to prevent accidental expensive copies
   Graph& operator=(const Graph&) = delete;
 
+  /**
+   * @brief Cheapest edge from u to v.
+   * @return The edge id, or -1 if the nodes are not adjacent.
+   */
+  int findEdge(const int u, const int v) const {
+    if (u < 0 || u >= nNodes) return -1;
+    int best = -1;
+    for (int i = ptrs[u]; i < ptrs[u + 1]; ++i)
+      if (targets[i] == v && (best == -1 || weights[i] < weights[best])) best = i;
+    return best;
+  }
+
   /**
    * @brief Overloads the << operator to print the graph.
    * @param out The output stream.
@@ -142,6 +223,21 @@ struct Graph {
 
     return out;
   }
+
+ private:
+  /**
+   * @brief Fills the structure-of-arrays view from `edges`.
+   */
+  void buildArrays() {
+    targets.resize(nEdges);
+    weights.resize(nEdges);
+    rev.resize(nEdges);
+    for (int i = 0; i < nEdges; ++i) {
+      targets[i] = edges[i].target;
+      weights[i] = edges[i].weight;
+      rev[i] = edges[i].reverseEdgePtr;
+    }
+  }
 };
 
 //---------------- Helper Functions ----------------
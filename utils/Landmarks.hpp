@@ -0,0 +1,91 @@
+#ifndef LANDMARKS_HPP
+#define LANDMARKS_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "Dijkstra.hpp"
+#include "Graph.hpp"
+
+/**
+ * @struct Landmarks
+ * @brief ALT (A*, Landmarks, Triangle inequality) preprocessing of a Graph.
+ * * Stores the distances from K landmarks to every node. For any landmark L
+ * the triangle inequality gives |d(L,u) - d(L,v)| <= d(u,v), which yields a
+ * consistent lower bound without coordinates. Landmarks are picked by
+ * farthest-point selection, so they end up on the border of the graph.
+ */
+struct Landmarks {
+  int nLandmarks;            ///< Number of landmarks (K)
+  std::vector<int> nodes;    ///< Landmark node ids
+  std::vector<float> dist;   ///< Node-major table: dist[v * K + k] = d(L_k, v)
+
+  /**
+   * @brief Runs K full Dijkstra expansions over the graph.
+   * @param graph The reference graph (original weights).
+   * @param k Number of landmarks, clamped to the number of nodes.
+   */
+  Landmarks(const std::shared_ptr<Graph>& graph, const int k)
+      : nLandmarks(std::min(k, graph->nNodes)) {
+    if (nLandmarks <= 0)
+      throw std::runtime_error("\t\tNumber of landmarks must be positive.");
+
+    const int n = graph->nNodes;
+    auto engine = DijkstraEngine::create(graph);
+    dist.resize(static_cast<size_t>(n) * nLandmarks);
+
+    // Closest landmark distance of each node, drives the farthest-point pick
+    std::vector<float> minDist(n, std::numeric_limits<float>::infinity());
+
+    // The first landmark is the node farthest from node 0
+    engine->exploreFrom({0});
+    int next = farthest(*engine, n);
+
+    for (int k = 0; k < nLandmarks; ++k) {
+      nodes.push_back(next);
+      engine->exploreFrom({next});
+
+      for (int v = 0; v < n; ++v) {
+        float d = engine->getDistance(v);
+        dist[static_cast<size_t>(v) * nLandmarks + k] = d;
+        minDist[v] = std::min(minDist[v], d);
+      }
+
+      next = static_cast<int>(std::max_element(minDist.begin(), minDist.end()) - minDist.begin());
+    }
+  }
+
+  size_t memoryBytes() const { return sizeof(*this) + vectorBytes(nodes) + vectorBytes(dist); }
+
+  /**
+   * @brief Distances of one node to every landmark.
+   */
+  const float* row(const int node) const {
+    return &dist[static_cast<size_t>(node) * nLandmarks];
+  }
+
+  /**
+   * @brief Lower bound of d(u, v) given the landmark row of v.
+   */
+  float lowerBound(const int u, const float* targetRow) const {
+    const float* r = row(u);
+    float best = 0.0f;
+    for (int k = 0; k < nLandmarks; ++k)
+      best = std::max(best, std::fabs(r[k] - targetRow[k]));
+    return best;
+  }
+
+ private:
+  static int farthest(const DijkstraEngine& engine, const int n) {
+    int best = 0;
+    for (int v = 1; v < n; ++v)
+      if (engine.getDistance(v) > engine.getDistance(best)) best = v;
+    return best;
+  }
+};
+
+#endif
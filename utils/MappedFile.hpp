@@ -0,0 +1,88 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SFP_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @class MappedFile
+ * @brief Read-only view over the whole content of a file.
+ * * Memory-maps the file on POSIX systems; elsewhere the file is read in a
+ * single block. Either way no per-token copies are made by the readers.
+ */
+class MappedFile {
+ private:
+  const char* data;
+  size_t length;
+#ifdef SFP_HAS_MMAP
+  void* mapping;
+#else
+  std::vector<char> buffer;
+#endif
+
+ public:
+  /**
+   * @brief Opens and maps the file.
+   * @param path Path of the file.
+   */
+  explicit MappedFile(const std::string& path) : data(nullptr), length(0) {
+#ifdef SFP_HAS_MMAP
+    mapping = nullptr;
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("\tThe file cannot be opened: " + path);
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+      ::close(fd);
+      throw std::runtime_error("\tThe file cannot be read: " + path);
+    }
+
+    length = static_cast<size_t>(info.st_size);
+    if (length > 0) {
+      mapping = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapping == MAP_FAILED) {
+        ::close(fd);
+        throw std::runtime_error("\tThe file cannot be mapped: " + path);
+      }
+      ::madvise(mapping, length, MADV_SEQUENTIAL);
+      data = static_cast<const char*>(mapping);
+    }
+    ::close(fd);
+#else
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in.is_open()) throw std::runtime_error("\tThe file cannot be opened: " + path);
+    length = static_cast<size_t>(in.tellg());
+    buffer.resize(length);
+    in.seekg(0);
+    if (length > 0 && !in.read(buffer.data(), length))
+      throw std::runtime_error("\tThe file cannot be read: " + path);
+    data = buffer.data();
+#endif
+  }
+
+  ~MappedFile() {
+#ifdef SFP_HAS_MMAP
+    if (mapping) ::munmap(mapping, length);
+#endif
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const char* begin() const { return data; }
+  const char* end() const { return data + length; }
+  size_t size() const { return length; }
+};
+
+#endif
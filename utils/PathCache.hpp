@@ -0,0 +1,120 @@
+#ifndef PATH_CACHE_HPP
+#define PATH_CACHE_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Stats.hpp"
+
+/**
+ * @class ShortestPathCache
+ * @brief Bounded, thread-safe memo of unconstrained shortest paths.
+ * * Holds the answers of queries run on an empty solution (no bridge, no
+ * ditch) of one graph, keyed by the ordered endpoint pair: point-to-point
+ * results of the bidirectional engine (path and cost) and one-to-many costs
+ * of the plain engine. Both kinds are kept apart and each is exact for the
+ * engine that produced it, so a hit returns what the search would have
+ * returned, ties included. Once `maxEdges` path edges (plus one per entry)
+ * are stored, new results are dropped instead of evicting old ones.
+ * * Entries are spread over mutex-guarded shards to keep concurrent workers
+ * from serializing on a single lock.
+ */
+class ShortestPathCache {
+ public:
+  static constexpr long long kDefaultMaxEdges = 1LL << 22;
+
+ private:
+  static constexpr int kShards = 16;
+
+  struct Shard {
+    std::mutex mutex;
+    std::unordered_map<uint64_t, std::pair<std::vector<int>, float>> paths;
+    std::unordered_map<uint64_t, float> costs;
+  };
+
+  std::array<Shard, kShards> shards;
+  const long long maxEdges;
+  std::atomic<long long> used{0};
+
+  static uint64_t key(const int source, const int target) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(source)) << 32) | static_cast<uint32_t>(target);
+  }
+
+  Shard& shardOf(const uint64_t k) { return shards[(k * 0x9E3779B97F4A7C15ULL) >> 60]; }
+
+  /// Reserves room for `size` units, false once the budget is spent
+  bool reserve(const long long size) {
+    long long now = used.load(std::memory_order_relaxed);
+    do {
+      if (now + size > maxEdges) return false;
+    } while (!used.compare_exchange_weak(now, now + size, std::memory_order_relaxed));
+    return true;
+  }
+
+ public:
+  explicit ShortestPathCache(const long long maxEdges = kDefaultMaxEdges) : maxEdges(maxEdges) {}
+
+  ShortestPathCache(const ShortestPathCache&) = delete;
+  ShortestPathCache& operator=(const ShortestPathCache&) = delete;
+
+  /**
+   * @brief Point-to-point result from source to target, if cached.
+   */
+  bool findPath(const int source, const int target, std::pair<std::vector<int>, float>& result) {
+    const uint64_t k = key(source, target);
+    Shard& shard = shardOf(k);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.paths.find(k);
+    if (it == shard.paths.end()) {
+      SFP_STAT_INC(PATH_CACHE_MISSES);
+      return false;
+    }
+    SFP_STAT_INC(PATH_CACHE_HITS);
+    result = it->second;
+    return true;
+  }
+
+  void storePath(const int source, const int target, const std::pair<std::vector<int>, float>& result) {
+    if (!reserve(result.first.size() + 1)) return;
+    const uint64_t k = key(source, target);
+    Shard& shard = shardOf(k);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    // Another worker may have stored the same answer meanwhile
+    if (!shard.paths.try_emplace(k, result).second) used -= result.first.size() + 1;
+  }
+
+  /**
+   * @brief One-to-many cost from source to target, if cached.
+   */
+  bool findCost(const int source, const int target, float& cost) {
+    const uint64_t k = key(source, target);
+    Shard& shard = shardOf(k);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.costs.find(k);
+    if (it == shard.costs.end()) {
+      SFP_STAT_INC(PATH_CACHE_MISSES);
+      return false;
+    }
+    SFP_STAT_INC(PATH_CACHE_HITS);
+    cost = it->second;
+    return true;
+  }
+
+  void storeCost(const int source, const int target, const float cost) {
+    if (!reserve(1)) return;
+    const uint64_t k = key(source, target);
+    Shard& shard = shardOf(k);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (!shard.costs.try_emplace(k, cost).second) used--;
+  }
+
+  /// Budget units in use (path edges plus one per entry)
+  long long size() const { return used.load(std::memory_order_relaxed); }
+};
+
+#endif
@@ -0,0 +1,250 @@
+#ifndef PRIORITY_QUEUE_HPP
+#define PRIORITY_QUEUE_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "Graph.hpp"
+
+/**
+ * @file PriorityQueue.hpp
+ * @brief Min-queue policies of the Dijkstra engines.
+ * * Every policy exposes the same members, so the engines take it as a
+ * template parameter: clear(), empty(), size(), push(key, node), topKey(),
+ * pop() -> {key, node} and memoryBytes(). Keys are float distances and ties are not
+ * ordered the same way by every policy.
+ */
+
+/**
+ * @brief Runtime name of a queue policy (CLI and SolverConfig).
+ */
+enum class QueueKind { AUTO, BINARY, QUATERNARY, RADIX };
+
+/**
+ * @class BinaryHeap
+ * @brief std::push_heap/pop_heap over a vector with lazy deletion.
+ * * Outdated entries stay in the heap and are skipped by the engines.
+ */
+class BinaryHeap {
+ private:
+  using Pii = std::pair<float, int>;
+  std::vector<Pii> heap;
+
+ public:
+  // Lazy deletion may push more entries than nodes; the vector grows on demand
+  BinaryHeap(const int nNodes, const int capacity) { heap.reserve(std::min(nNodes, capacity)); }
+
+  void clear() { heap.clear(); }
+  bool empty() const { return heap.empty(); }
+  size_t size() const { return heap.size(); }
+  size_t memoryBytes() const { return vectorBytes(heap); }
+
+  void push(const float key, const int node) {
+    heap.push_back({key, node});
+    std::push_heap(heap.begin(), heap.end(), std::greater<Pii>());
+  }
+
+  float topKey() const { return heap.front().first; }
+
+  Pii pop() {
+    std::pop_heap(heap.begin(), heap.end(), std::greater<Pii>());
+    Pii top = heap.back();
+    heap.pop_back();
+    return top;
+  }
+};
+
+/**
+ * @class QuaternaryHeap
+ * @brief Indexed 4-ary heap with decrease-key.
+ * * Holds at most one entry per node, so the heap is bounded by the number
+ * of nodes instead of the number of relaxations. Pushing a node already in
+ * the heap lowers its key.
+ */
+class QuaternaryHeap {
+ private:
+  using Pii = std::pair<float, int>;
+  std::vector<Pii> heap;
+  std::vector<int> pos;  ///< Slot of each node in the heap, -1 if absent
+
+  void place(const int slot, const Pii& entry) {
+    heap[slot] = entry;
+    pos[entry.second] = slot;
+  }
+
+  void siftUp(int slot) {
+    Pii entry = heap[slot];
+    while (slot > 0) {
+      int parent = (slot - 1) >> 2;
+      if (!(entry < heap[parent])) break;
+      place(slot, heap[parent]);
+      slot = parent;
+    }
+    place(slot, entry);
+  }
+
+  void siftDown(int slot) {
+    const int n = heap.size();
+    Pii entry = heap[slot];
+    while (true) {
+      int first = (slot << 2) + 1;
+      if (first >= n) break;
+      int best = first;
+      int last = std::min(first + 4, n);
+      for (int c = first + 1; c < last; ++c)
+        if (heap[c] < heap[best]) best = c;
+      if (!(heap[best] < entry)) break;
+      place(slot, heap[best]);
+      slot = best;
+    }
+    place(slot, entry);
+  }
+
+ public:
+  QuaternaryHeap(const int nNodes, const int /*capacity*/) : pos(nNodes, -1) {
+    heap.reserve(nNodes);
+  }
+
+  void clear() {
+    for (const auto& entry : heap) pos[entry.second] = -1;
+    heap.clear();
+  }
+  size_t memoryBytes() const { return vectorBytes(heap) + vectorBytes(pos); }
+  bool empty() const { return heap.empty(); }
+  size_t size() const { return heap.size(); }
+
+  void push(const float key, const int node) {
+    int slot = pos[node];
+    if (slot == -1) {
+      heap.push_back({key, node});
+      siftUp(heap.size() - 1);
+    } else if (key < heap[slot].first) {
+      heap[slot].first = key;
+      siftUp(slot);
+    }
+  }
+
+  float topKey() const { return heap.front().first; }
+
+  Pii pop() {
+    Pii top = heap.front();
+    pos[top.second] = -1;
+    Pii last = heap.back();
+    heap.pop_back();
+    if (!heap.empty()) {
+      heap[0] = last;
+      siftDown(0);
+    }
+    return top;
+  }
+};
+
+/**
+ * @class RadixHeap
+ * @brief Monotone radix heap over the bit patterns of the float keys.
+ * * Keys are mapped to order-preserving 32-bit integers and bucketed by the
+ * highest bit that differs from the last extracted key, so each entry moves
+ * down at most 32 times. Dijkstra keys never decrease; keys that fall below
+ * the last extracted one through float rounding (ALT potentials) are
+ * bucketed as if equal to it, and pop() still returns the original key.
+ */
+class RadixHeap {
+ private:
+  struct Entry {
+    uint32_t code;
+    float key;
+    int node;
+  };
+  static constexpr int kBuckets = 33;
+  std::vector<Entry> buckets[kBuckets];
+  uint32_t last;
+  size_t count;
+
+  static uint32_t encode(const float key) {
+    uint32_t bits;
+    std::memcpy(&bits, &key, sizeof(bits));
+    return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+  }
+
+  int bucketOf(const uint32_t code) const {
+    uint32_t diff = code ^ last;
+#if defined(__GNUC__) || defined(__clang__)
+    return diff ? 32 - __builtin_clz(diff) : 0;
+#else
+    int b = 0;
+    while (diff) {
+      diff >>= 1;
+      ++b;
+    }
+    return b;
+#endif
+  }
+
+  // Refills bucket 0 from the first non-empty bucket
+  void pull() {
+    int b = 1;
+    while (buckets[b].empty()) ++b;
+
+    auto& source = buckets[b];
+    uint32_t smallest = source.front().code;
+    for (const auto& entry : source) smallest = std::min(smallest, entry.code);
+    last = smallest;
+
+    for (const auto& entry : source) buckets[bucketOf(entry.code)].push_back(entry);
+    source.clear();
+  }
+
+ public:
+  RadixHeap(const int /*nNodes*/, const int /*capacity*/) : last(0), count(0) {}
+
+  void clear() {
+    for (auto& bucket : buckets) bucket.clear();
+    last = 0;
+    count = 0;
+  }
+  bool empty() const { return count == 0; }
+  size_t size() const { return count; }
+  size_t memoryBytes() const {
+    size_t bytes = 0;
+    for (const auto& bucket : buckets) bytes += vectorBytes(bucket);
+    return bytes;
+  }
+
+  void push(const float key, const int node) {
+    uint32_t code = std::max(encode(key), last);
+    buckets[bucketOf(code)].push_back({code, key, node});
+    ++count;
+  }
+
+  float topKey() {
+    if (buckets[0].empty()) pull();
+    return buckets[0].back().key;
+  }
+
+  std::pair<float, int> pop() {
+    if (buckets[0].empty()) pull();
+    Entry top = buckets[0].back();
+    buckets[0].pop_back();
+    --count;
+    return {top.key, top.node};
+  }
+};
+
+/**
+ * @brief Resolves AUTO for a graph: the radix heap needs monotone keys, so it
+ * is picked when no weight is negative and every weight is integral (all the
+ * STP benchmark sets); the binary heap otherwise.
+ */
+inline QueueKind resolveQueueKind(const QueueKind kind, const Graph& graph) {
+  if (kind != QueueKind::AUTO) return kind;
+  for (float w : graph.weights)
+    if (w < 0.0f || w != static_cast<float>(static_cast<long long>(w)))
+      return QueueKind::BINARY;
+  return QueueKind::RADIX;
+}
+
+#endif
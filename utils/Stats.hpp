@@ -0,0 +1,193 @@
+#ifndef STATS_HPP
+#define STATS_HPP
+
+#include <array>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <ostream>
+
+/**
+ * @file Stats.hpp
+ * @brief Opt-in instrumentation: event counters and phase timers.
+ * * The SFP_STAT_* macros only do something when SFP_STATS is defined (CMake
+ * option of the same name); otherwise they expand to nothing and the hot
+ * loops are untouched. Each thread bumps its own block, without locks or
+ * atomics. Blocks are owned by a registry and summed by Stats::total(), which
+ * must run once the workers are joined or idle.
+ */
+
+enum class StatCounter : int {
+  BIDIJKSTRA_QUERIES,  ///< BidirectionalDijkstraEngine::getShortPath calls
+  DIJKSTRA_QUERIES,    ///< DijkstraEngine searches (single, one-to-many, explore)
+  SETTLED_NODES,       ///< Non-stale queue pops of every engine
+  HEAP_PUSHES,         ///< Queue pushes of every engine
+  SOLUTION_INSERTS,    ///< SFPSolution::insert calls
+  SOLUTION_ERASES,     ///< SFPSolution::erase calls
+  GRASP_LS_TRIED,      ///< Edge drops priced (discarded batch mates included)
+  GRASP_LS_ACCEPTED,
+  HUB_LS_TRIED,        ///< Hub breaks priced
+  HUB_LS_ACCEPTED,
+  PATH_CACHE_HITS,     ///< ShortestPathCache lookups answered
+  PATH_CACHE_MISSES,
+  COUNT
+};
+
+/// Timers may nest (e.g. the shortest paths of a local search pass)
+enum class StatTimer : int {
+  PARSE,          ///< SFPProblem::loadFile
+  GRAPH_BUILD,    ///< CSR construction
+  CONSTRUCTIVE,   ///< Constructive and warm start generations
+  GRASP_LS,       ///< GRASPLocalSearch::optimize
+  HUB_LS,         ///< HubBreakingLocalSearch::optimize
+  SHORTEST_PATH,  ///< Bidirectional point-to-point queries
+  COUNT
+};
+
+/**
+ * @class Stats
+ * @brief Per-thread counter blocks and their reduction.
+ */
+class Stats {
+ public:
+  static constexpr int kCounters = static_cast<int>(StatCounter::COUNT);
+  static constexpr int kTimers = static_cast<int>(StatTimer::COUNT);
+
+#ifdef SFP_STATS
+  static constexpr bool kEnabled = true;
+#else
+  static constexpr bool kEnabled = false;
+#endif
+
+  struct Block {
+    std::array<unsigned long long, kCounters> counters{};
+    std::array<unsigned long long, kTimers> timerNs{};
+    std::array<unsigned long long, kTimers> timerCalls{};
+  };
+
+  static Block& local() {
+    thread_local Block* block = registry().add();
+    return *block;
+  }
+
+  static void add(const StatCounter counter, const unsigned long long n) {
+    local().counters[static_cast<int>(counter)] += n;
+  }
+
+  static void addTime(const StatTimer timer, const unsigned long long ns) {
+    Block& block = local();
+    block.timerNs[static_cast<int>(timer)] += ns;
+    block.timerCalls[static_cast<int>(timer)]++;
+  }
+
+  /**
+   * @brief Sum of the blocks of every thread that recorded something.
+   */
+  static Block total() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    Block sum;
+    for (const Block& block : r.blocks) {
+      for (int k = 0; k < kCounters; ++k) sum.counters[k] += block.counters[k];
+      for (int k = 0; k < kTimers; ++k) {
+        sum.timerNs[k] += block.timerNs[k];
+        sum.timerCalls[k] += block.timerCalls[k];
+      }
+    }
+    return sum;
+  }
+
+  /**
+   * @brief Writes total() as a JSON object, with a few derived ratios.
+   */
+  static void writeJSON(std::ostream& out) {
+    static const char* counterNames[kCounters] = {
+        "bidijkstra_queries", "dijkstra_queries", "settled_nodes", "heap_pushes",
+        "solution_inserts", "solution_erases", "grasp_ls_tried", "grasp_ls_accepted",
+        "hub_ls_tried", "hub_ls_accepted", "path_cache_hits", "path_cache_misses"};
+    static const char* timerNames[kTimers] = {
+        "parse", "graph_build", "constructive", "grasp_ls", "hub_ls", "shortest_path"};
+
+    const Block sum = total();
+    auto count = [&](const StatCounter c) { return sum.counters[static_cast<int>(c)]; };
+    auto ratio = [](const double a, const double b) { return b > 0 ? a / b : 0.0; };
+
+    out << "{\n  \"counters\": {";
+    for (int k = 0; k < kCounters; ++k)
+      out << (k ? ", " : "") << "\"" << counterNames[k] << "\": " << sum.counters[k];
+    out << "},\n  \"timers\": {";
+    for (int k = 0; k < kTimers; ++k)
+      out << (k ? ", " : "") << "\"" << timerNames[k] << "\": {\"ms\": " << sum.timerNs[k] * 1e-6
+          << ", \"calls\": " << sum.timerCalls[k] << "}";
+
+    const double queries = count(StatCounter::BIDIJKSTRA_QUERIES) + count(StatCounter::DIJKSTRA_QUERIES);
+    out << "},\n  \"derived\": {\"settled_per_query\": " << ratio(count(StatCounter::SETTLED_NODES), queries)
+        << ", \"grasp_ls_rejected\": "
+        << count(StatCounter::GRASP_LS_TRIED) - count(StatCounter::GRASP_LS_ACCEPTED)
+        << ", \"grasp_ls_acceptance\": "
+        << ratio(count(StatCounter::GRASP_LS_ACCEPTED), count(StatCounter::GRASP_LS_TRIED))
+        << ", \"hub_ls_rejected\": "
+        << count(StatCounter::HUB_LS_TRIED) - count(StatCounter::HUB_LS_ACCEPTED)
+        << ", \"hub_ls_acceptance\": "
+        << ratio(count(StatCounter::HUB_LS_ACCEPTED), count(StatCounter::HUB_LS_TRIED))
+        << ", \"path_cache_hit_rate\": "
+        << ratio(count(StatCounter::PATH_CACHE_HITS),
+                 count(StatCounter::PATH_CACHE_HITS) + count(StatCounter::PATH_CACHE_MISSES))
+        << "}\n}\n";
+  }
+
+ private:
+  struct Registry {
+    std::mutex mutex;
+    std::deque<Block> blocks;  ///< Stable addresses, outlive their threads
+
+    Block* add() {
+      std::lock_guard<std::mutex> lock(mutex);
+      blocks.emplace_back();
+      return &blocks.back();
+    }
+  };
+
+  static Registry& registry() {
+    static Registry r;
+    return r;
+  }
+};
+
+/**
+ * @class ScopedStatTimer
+ * @brief Adds the lifetime of the object to a timer.
+ */
+class ScopedStatTimer {
+ private:
+  StatTimer timer;
+  std::chrono::steady_clock::time_point start;
+
+ public:
+  explicit ScopedStatTimer(const StatTimer timer)
+      : timer(timer), start(std::chrono::steady_clock::now()) {}
+  ~ScopedStatTimer() {
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start);
+    Stats::addTime(timer, ns.count());
+  }
+
+  ScopedStatTimer(const ScopedStatTimer&) = delete;
+  ScopedStatTimer& operator=(const ScopedStatTimer&) = delete;
+};
+
+#define SFP_STAT_CONCAT_(a, b) a##b
+#define SFP_STAT_CONCAT(a, b) SFP_STAT_CONCAT_(a, b)
+
+#ifdef SFP_STATS
+#define SFP_STAT_ADD(counter, n) Stats::add(StatCounter::counter, (n))
+#define SFP_STAT_INC(counter) Stats::add(StatCounter::counter, 1)
+#define SFP_STAT_TIMER(timer) \
+  ScopedStatTimer SFP_STAT_CONCAT(sfpStatTimer, __LINE__)(StatTimer::timer)
+#else
+#define SFP_STAT_ADD(counter, n) ((void)0)
+#define SFP_STAT_INC(counter) ((void)0)
+#define SFP_STAT_TIMER(timer) ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class ThreadPool
+ * @brief Persistent workers running parallel-for loops.
+ * * The calling thread takes part as worker 0, so a pool of size 1 spawns no
+ * thread at all. Tasks are handed out dynamically, and the worker index lets
+ * the caller keep one scratch buffer (engine, mask...) per worker.
+ */
+class ThreadPool {
+ private:
+  using Task = std::function<void(int task, int worker)>;
+
+  std::vector<std::thread> threads;
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::condition_variable done;
+
+  const Task* job;
+  int nTasks;
+  std::atomic<int> next;
+  int busy;
+  unsigned long long generation;
+  bool stopping;
+  std::exception_ptr error;
+
+  void drain(const int worker) {
+    for (int task = next++; task < nTasks; task = next++) {
+      try {
+        (*job)(task, worker);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!error) error = std::current_exception();
+      }
+    }
+  }
+
+  void workerLoop(const int worker) {
+    unsigned long long seen = 0;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        wake.wait(lock, [&] { return stopping || generation != seen; });
+        if (stopping) return;
+        seen = generation;
+      }
+      drain(worker);
+      std::lock_guard<std::mutex> lock(mutex);
+      if (--busy == 0) done.notify_one();
+    }
+  }
+
+ public:
+  /**
+   * @param nThreads Total workers, including the calling thread.
+   */
+  explicit ThreadPool(const int nThreads)
+      : job(nullptr), nTasks(0), next(0), busy(0), generation(0), stopping(false) {
+    for (int w = 1; w < nThreads; ++w) threads.emplace_back(&ThreadPool::workerLoop, this, w);
+  }
+
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    wake.notify_all();
+    for (auto& thread : threads) thread.join();
+  }
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  int size() const { return static_cast<int>(threads.size()) + 1; }
+
+  /**
+   * @brief Runs task(i, worker) for every i in [0, count) and waits for all.
+   * @throws The first exception thrown by a task.
+   */
+  void parallelFor(const int count, const Task& task) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      job = &task;
+      nTasks = count;
+      next = 0;
+      busy = threads.size();
+      error = nullptr;
+      generation++;
+    }
+    wake.notify_all();
+    drain(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&] { return busy == 0; });
+    job = nullptr;
+    if (error) std::rethrow_exception(error);
+  }
+};
+
+#endif